@@ -852,6 +852,7 @@ YApm::YApm(YWindow *aParent, bool autodetect):
     apmFont = apmFontName;
     updateState();
 
+    apmTimer->setAligned();
     apmTimer->setTimer(1000 * batteryPollingPeriod, this, true);
 
     if (taskBarShowApmGraph)
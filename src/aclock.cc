@@ -57,6 +57,7 @@ YClock::YClock(YSMListener* sml, IAppletContainer* iapp, YWindow* parent,
         ledPixSpace = ledPixSpace->scale(5, ledPixSpace->height());
 
     clockTimer->setFixed();
+    clockTimer->setAligned();
     clockTimer->setTimer(1000, this, true);
 
     autoSize();
@@ -315,7 +316,7 @@ void YClock::fill(Graphics& g)
         ref<YImage> gradient(getGradient());
 
         if (gradient != null)
-            g.drawImage(gradient, this->x(), this->y(),
+            g.drawCached(gradient, this->x(), this->y(),
                          width(), height(), 0, 0);
         else
         if (taskbackPixmap != null) {
@@ -338,7 +339,7 @@ void YClock::fill(Graphics& g, int x, int y, int w, int h)
     else {
         ref<YImage> gradient(getGradient());
         if (gradient != null) {
-            g.drawImage(gradient, this->x() + x, this->y() + y,
+            g.drawCached(gradient, this->x() + x, this->y() + y,
                          w, h, x, y);
         }
         else if (taskbackPixmap != null) {
@@ -224,8 +224,8 @@ void CPUStatus::fill(Graphics& g) {
         ref<YImage> gradient(getGradient());
 
         if (gradient != null)
-            g.drawImage(gradient,
-                        x(), y(), width(), height(), 0, 0);
+            g.drawCached(gradient,
+                         x(), y(), width(), height(), 0, 0);
         else
             if (taskbackPixmap != null)
                 g.fillPixmap(taskbackPixmap,
@@ -242,6 +242,8 @@ void CPUStatus::draw(Graphics& g) {
                     ? taskBarCPUSamples - statusUpdateCount : taskBarCPUSamples;
     statusUpdateCount = 0;
 
+    // one request per color instead of two per bar
+    GraphicsBatch batch(g);
     for (int i = first; i < limit; i++) {
         unsigned long long
             user    = cpu[i][IWM_USER],
@@ -262,29 +264,26 @@ void CPUStatus::draw(Graphics& g) {
                 iowaitbar, softirqbar, stealbar, totalbar = 0,
                 round = total / h / 2;  /* compute also with rounding errs */
             if ((stealbar = (h * (steal + round)) / total)) {
-                g.setColor(color[IWM_STEAL]);
-                g.drawLine(i, y, i, y - (stealbar - 1));
+                batch.drawLine(color[IWM_STEAL], i, y, i, y - (stealbar - 1));
                 y -= stealbar;
             }
             totalbar += stealbar;
 
             if ((intrbar = (h * (intr + round)) / total)) {
-                g.setColor(color[IWM_INTR]);
-                g.drawLine(i, y, i, y - (intrbar - 1));
+                batch.drawLine(color[IWM_INTR], i, y, i, y - (intrbar - 1));
                 y -= intrbar;
             }
             totalbar += intrbar;
             if ((softirqbar = (h * (softirq + round)) / total)) {
-                g.setColor(color[IWM_SOFTIRQ]);
-                g.drawLine(i, y, i, y - (softirqbar - 1));
+                batch.drawLine(color[IWM_SOFTIRQ],
+                               i, y, i, y - (softirqbar - 1));
                 y -= softirqbar;
             }
             totalbar += softirqbar;
             iowaitbar = (h * (iowait + round)) / total;
             totalbar += iowaitbar;
             if ((sysbar = (h * (sys + round)) / total)) {
-                g.setColor(color[IWM_SYS]);
-                g.drawLine(i, y, i, y - (sysbar - 1));
+                batch.drawLine(color[IWM_SYS], i, y, i, y - (sysbar - 1));
                 y -= sysbar;
             }
             totalbar += sysbar;
@@ -295,19 +294,16 @@ void CPUStatus::draw(Graphics& g) {
             /* minor rounding errors are counted into user bar: */
             if ((userbar = (h * ((total - idle) + round)) / total - totalbar))
             {
-                g.setColor(color[IWM_USER]);
-                g.drawLine(i, y, i, y - (userbar - 1));
+                batch.drawLine(color[IWM_USER], i, y, i, y - (userbar - 1));
                 y -= userbar;
             }
 
             if (nicebar) {
-                g.setColor(color[IWM_NICE]);
-                g.drawLine(i, y, i, y - (nicebar - 1));
+                batch.drawLine(color[IWM_NICE], i, y, i, y - (nicebar - 1));
                 y -= nicebar;
             }
             if (iowaitbar) {
-                g.setColor(color[IWM_IOWAIT]);
-                g.drawLine(i, y, i, y - (iowaitbar - 1));
+                batch.drawLine(color[IWM_IOWAIT], i, y, i, y - (iowaitbar - 1));
                 y -= iowaitbar;
             }
          /* MSG((_("stat:\tuser = %llu, nice = %llu, sys = %llu, idle = %llu, "
@@ -322,13 +318,12 @@ void CPUStatus::draw(Graphics& g) {
         }
         if (y > 0) {
             if (color[IWM_IDLE]) {
-                g.setColor(color[IWM_IDLE]);
-                g.drawLine(i, 0, i, y);
+                batch.drawLine(color[IWM_IDLE], i, 0, i, y);
             } else {
                 ref<YImage> gradient(getGradient());
 
                 if (gradient != null)
-                    g.drawImage(gradient,
+                    g.drawCached(gradient,
                                  this->x() + i, this->y(), width(), y + 1, i, 0);
                 else
                     if (taskbackPixmap != null)
@@ -402,6 +397,7 @@ private:
             if (read_data(thermal[index].name)) {
                 thermal[index].temp = data = atoi(buf);
                 if (data && timer.isRunning() == false) {
+                    timer.setAligned();
                     timer.setTimer(max(1000, taskBarCPUDelay) - 1, this, true);
                 }
             }
@@ -668,8 +664,7 @@ void CPUStatus::handleClick(const XButtonEvent &up, int count) {
 }
 
 void CPUStatus::updateStatus() {
-    for (int i(1); i < taskBarCPUSamples; i++)
-        cpu.copyTo(i, i - 1);
+    cpu.rotate();
     getStatus();
     repaint();
 }
@@ -846,6 +841,7 @@ CPUStatusControl::CPUStatusControl(YSMListener *smActionListener,
     fPid(0)
 {
     GetCPUStatus(cpuCombine);
+    fUpdateTimer.setAligned();
     fUpdateTimer.setTimer(taskBarCPUDelay, this, true);
 }
 
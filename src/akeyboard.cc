@@ -197,7 +197,7 @@ void KeyboardStatus::fill(Graphics& g) {
     ref<YImage> gradient(getGradient());
 
     if (gradient != null) {
-        g.drawImage(gradient, x(), y(), width(), height(), 0, 0);
+        g.drawCached(gradient, x(), y(), width(), height(), 0, 0);
     }
     else if (taskbackPixmap != null) {
         g.fillPixmap(taskbackPixmap, 0, 0, width(), height(), x(), y());
@@ -13,6 +13,7 @@
 #include "wmapp.h"
 #include "wpixmaps.h"
 #include "udir.h"
+#include "ywork.h"
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -27,6 +28,40 @@
 
 extern YColorName taskBarBg;
 
+// getaddrinfo may block for a long time on a slow name server
+class MailResolver: public YJob {
+public:
+    MailResolver(MailCheck* check, const char* host, int port,
+                 const addrinfo& hints):
+        fCheck(check),
+        fHost(newstr(host)),
+        fHints(hints),
+        fResult(nullptr),
+        fError(0)
+    {
+        snprintf(fPort, sizeof fPort, "%d", port);
+    }
+    ~MailResolver() {
+        if (fResult)
+            freeaddrinfo(fResult);
+    }
+    virtual void run() {
+        fError = getaddrinfo(fHost, fPort, &fHints, &fResult);
+    }
+    virtual void done() {
+        addrinfo* result = fResult;
+        fResult = nullptr;
+        fCheck->resolved(fError, result);
+    }
+private:
+    MailCheck* fCheck;
+    csmart fHost;
+    char fPort[12];
+    addrinfo fHints;
+    addrinfo* fResult;
+    int fError;
+};
+
 int MailCheck::fInstanceCounter;
 int MailCheck::fDestructCounter;
 csmart MailCheck::openssl_path;
@@ -46,6 +81,8 @@ MailCheck::MailCheck(mstring url, MailBoxStatus *mbx):
     fLastCountSize(-1),
     fLastCountTime(0),
     fAddr(nullptr),
+    fResolver(nullptr),
+    fCheckResolved(false),
     fPort(0),
     fPid(0),
     fInst(++fInstanceCounter),
@@ -71,6 +108,10 @@ MailCheck::MailCheck(mstring url, MailBoxStatus *mbx):
 }
 
 MailCheck::~MailCheck() {
+    if (fResolver) {
+        mainLoop->cancelJob(fResolver);
+        fResolver = nullptr;
+    }
     release();
     if (fAddr) {
         freeaddrinfo(fAddr);
@@ -134,22 +175,13 @@ void MailCheck::resolve() {
             hints.ai_family = AF_INET6;
             hints.ai_flags |= AI_NUMERICHOST;
         }
-        int rc = getaddrinfo(fURL.host, mstring(fPort), &hints, &fAddr);
-        if (rc) {
-            snprintf(bf, sizeof bf,
-                     _("DNS name lookup failed for %s"),
-                     fURL.host.c_str());
-            warn("%s: %s", bf, gai_strerror(rc));
-            snprintf(bf + strlen(bf), sizeof bf - strlen(bf),
-                     "\n%s", gai_strerror(rc));
-            reason(bf);
-            setState(ERROR);
-        }
-        for (addrinfo* rp = fAddr; rp && fTrace; rp = rp->ai_next) {
-            getnameinfo(rp->ai_addr, rp->ai_addrlen, bf, 64,
-                        bf + 64, 64, NI_NUMERICHOST | NI_NUMERICSERV);
-            tlog("(%d) af %d: so %d: pr %d: %s: %s.", fInst,
-                 rp->ai_family, rp->ai_socktype, rp->ai_protocol, bf, bf + 64);
+        if (hints.ai_flags & AI_NUMERICHOST) {
+            addrinfo* addr = nullptr;
+            int rc = getaddrinfo(fURL.host, mstring(fPort), &hints, &addr);
+            resolved(rc, addr);
+        } else {
+            fResolver = new MailResolver(this, fURL.host, fPort, hints);
+            mainLoop->submitJob(fResolver);
         }
     } else {
         snprintf(bf, sizeof bf,
@@ -160,6 +192,31 @@ void MailCheck::resolve() {
     }
 }
 
+void MailCheck::resolved(int rc, addrinfo* addr) {
+    fResolver = nullptr;
+    fAddr = addr;
+    if (rc) {
+        snprintf(bf, sizeof bf,
+                 _("DNS name lookup failed for %s"),
+                 fURL.host.c_str());
+        warn("%s: %s", bf, gai_strerror(rc));
+        snprintf(bf + strlen(bf), sizeof bf - strlen(bf),
+                 "\n%s", gai_strerror(rc));
+        reason(bf);
+        setState(ERROR);
+    }
+    for (addrinfo* rp = fAddr; rp && fTrace; rp = rp->ai_next) {
+        getnameinfo(rp->ai_addr, rp->ai_addrlen, bf, 64,
+                    bf + 64, 64, NI_NUMERICHOST | NI_NUMERICSERV);
+        tlog("(%d) af %d: so %d: pr %d: %s: %s.", fInst,
+             rp->ai_family, rp->ai_socktype, rp->ai_protocol, bf, bf + 64);
+    }
+    if (fCheckResolved) {
+        fCheckResolved = false;
+        startCheck();
+    }
+}
+
 void MailCheck::countMessages() {
     int fd = open(fURL.path, O_RDONLY);
     long mails = 0;
@@ -304,6 +361,10 @@ void MailCheck::startCheck() {
             if (fTrace) tlog("(%d) starting SSL", fInst);
             startSSL();
         }
+        else if (fResolver) {
+            // connect once the lookup completes
+            fCheckResolved = true;
+        }
         else if (fAddr && sk.connect(fAddr->ai_addr, fAddr->ai_addrlen) == 0) {
             if (fTrace) tlog("(%d) connected non-SSL", fInst);
             setState(CONNECTING);
@@ -749,7 +810,7 @@ void MailBoxStatus::draw(Graphics& g) {
         ref<YImage> gradient(getGradient());
 
         if (gradient != null)
-            g.drawImage(gradient, x(), y(), width(), height(), 0, 0);
+            g.drawCached(gradient, x(), y(), width(), height(), 0, 0);
         else
             if (taskbackPixmap != null)
                 g.fillPixmap(taskbackPixmap,
@@ -869,6 +930,7 @@ MailBoxControl::MailBoxControl(IApp *app, YSMListener *smActionListener,
 {
     populate();
     if (fDelay && fMailBoxes.nonempty()) {
+        fCheckTimer->setAligned();
         fCheckTimer->setTimer(fDelta * 1000L, this, true);
     }
 }
@@ -95,6 +95,8 @@ private:
     long fLastCountSize;
     time_t fLastCountTime;
     struct addrinfo* fAddr;
+    class YJob* fResolver;
+    bool fCheckResolved;
     int fPort;
     int fPid;
     int fInst;
@@ -105,6 +107,8 @@ private:
     static csmart openssl_path;
 
     void resolve();
+    void resolved(int rc, struct addrinfo* addr);
+    friend class MailResolver;
     void countMessages();
     const char* s(ProtocolState t);
     void escape(const char* buf, int len, char* tmp, int siz);
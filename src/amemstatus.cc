@@ -29,6 +29,7 @@ MEMStatus::MEMStatus(IAppletContainer* taskBar, YWindow *aParent):
     unchanged(taskBarMEMSamples),
     taskBar(taskBar)
 {
+    fUpdateTimer->setAligned();
     fUpdateTimer->setTimer(taskBarMEMDelay, this, true);
 
     color[MEM_USER] = &clrMemUser;
@@ -70,8 +71,8 @@ void MEMStatus::fill(Graphics& g) {
         ref<YImage> gradient(getGradient());
 
         if (gradient != null)
-            g.drawImage(gradient,
-                        x(), y(), width(), height(), 0, 0);
+            g.drawCached(gradient,
+                         x(), y(), width(), height(), 0, 0);
         else
             if (taskbackPixmap != null)
                 g.fillPixmap(taskbackPixmap,
@@ -88,6 +89,8 @@ void MEMStatus::draw(Graphics& g) {
                     ? taskBarMEMSamples - statusUpdateCount : taskBarMEMSamples;
     statusUpdateCount = 0;
 
+    // one request per color instead of two per bar
+    GraphicsBatch batch(g);
     for (int i = first; i < limit; i++) {
         membytes total = samples.sum(i);
 
@@ -105,16 +108,15 @@ void MEMStatus::draw(Graphics& g) {
             }
 
             if (color[j]) {
-                g.setColor(color[j]);
-                g.drawLine(i, y-1, i, y-bar);
+                batch.drawLine(color[j], i, y-1, i, y-bar);
             } else {
                 ref<YImage> gradient(getGradient());
 
                 if (gradient != null)
-                    g.drawImage(gradient,
-                                this->x() + i, this->y() + y - bar,
-                                width(), bar,
-                                i, y - bar);
+                    g.drawCached(gradient,
+                                 this->x() + i, this->y() + y - bar,
+                                 width(), bar,
+                                 i, y - bar);
                 else
                     if (taskbackPixmap != null)
                         g.fillPixmap(taskbackPixmap,
@@ -184,9 +186,7 @@ void MEMStatus::updateToolTip() {
 }
 
 void MEMStatus::updateStatus() {
-    for (int i(1); i < taskBarMEMSamples; i++) {
-        samples.copyTo(i, i - 1);
-    }
+    samples.rotate();
     getStatus();
     repaint();
 }
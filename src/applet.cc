@@ -26,6 +26,7 @@ IApplet::~IApplet()
 void IApplet::freePixmap()
 {
     if (fPixmap) {
+        Graphics::forget(fPixmap);
         XFreePixmap(xapp->display(), fPixmap);
         fPixmap = None;
     }
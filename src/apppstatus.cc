@@ -131,8 +131,7 @@ NetStatus::NetStatus(
     fColorRecv(&clrNetReceive),
     fColorSend(&clrNetSend),
     fColorIdle(&clrNetIdle),
-    ppp_in(new long[taskBarNetSamples]),
-    ppp_out(new long[taskBarNetSamples]),
+    ppp(taskBarNetSamples, PPP_STATES),
     prev_ibytes(0),
     start_ibytes(0),
     cur_ibytes(0),
@@ -150,8 +149,7 @@ NetStatus::NetStatus(
     fDevName(netdev),
     fDevice(getNetDevice(netdev))
 {
-    for (int i = 0; i < taskBarNetSamples; i++)
-        ppp_in[i] = ppp_out[i] = 0;
+    ppp.clear();
 
     setSize(taskBarNetSamples, taskBarGraphHeight);
 
@@ -164,8 +162,6 @@ NetStatus::NetStatus(
 }
 
 NetStatus::~NetStatus() {
-    delete[] ppp_in;
-    delete[] ppp_out;
     delete fDevice;
 }
 
@@ -187,8 +183,7 @@ void NetStatus::timedUpdate(const char* sharedData, bool forceDown) {
 
     if (up) {
         if (!wasUp) {
-            for (int i = 0; i < taskBarNetSamples; i++)
-                ppp_in[i] = ppp_out[i] = 0;
+            ppp.clear();
 
             start_time = monotime();
             cur_ibytes = 0;
@@ -226,8 +221,8 @@ void NetStatus::updateToolTip() {
         long long vi(cur_ibytes);
         long long vo(cur_obytes);
 
-        long ci(ppp_in[taskBarNetSamples - 1]);
-        long co(ppp_out[taskBarNetSamples - 1]);
+        long ci(ppp[taskBarNetSamples - 1][PPP_IN]);
+        long co(ppp[taskBarNetSamples - 1][PPP_OUT]);
 
         /* ai and oi were keeping nonsenses (if were not reset by
          * double-click) because of bad control of start_obytes and
@@ -242,8 +237,8 @@ void NetStatus::updateToolTip() {
         long long cao = 0;
 
         for (int ii = 0; ii < taskBarNetSamples; ii++) {
-            cai += ppp_in[ii];
-            cao += ppp_out[ii];
+            cai += ppp[ii][PPP_IN];
+            cao += ppp[ii][PPP_OUT];
         }
         cai /= taskBarNetSamples;
         cao /= taskBarNetSamples;
@@ -325,8 +320,8 @@ void NetStatus::fill(Graphics& g) {
         ref<YImage> gradient(getGradient());
 
         if (gradient != null)
-            g.drawImage(gradient,
-                        x(), y(), width(), height(), 0, 0);
+            g.drawCached(gradient,
+                         x(), y(), width(), height(), 0, 0);
         else
             if (taskbackPixmap != null)
                 g.fillPixmap(taskbackPixmap,
@@ -341,8 +336,8 @@ void NetStatus::draw(Graphics &g) {
     long b_out_max = 0;
 
     for (int i = 0; i < taskBarNetSamples; i++) {
-        long in = ppp_in[i];
-        long out = ppp_out[i];
+        long in = ppp[i][PPP_IN];
+        long out = ppp[i][PPP_OUT];
         if (in > b_in_max)
             b_in_max = in;
         if (out > b_out_max)
@@ -359,19 +354,23 @@ void NetStatus::draw(Graphics &g) {
     statusUpdateCount = 0;
     oldMaxBytes = maxBytes;
 
+    // one request per color instead of two per bar
+    GraphicsBatch batch(g);
     for (int i = first; i < limit; i++) {
-        if (true /* ppp_in[i] > 0 || ppp_out[i] > 0 */) {
+        if (true /* ppp[i][PPP_IN] > 0 || ppp[i][PPP_OUT] > 0 */) {
             long round = maxBytes / h / 2;
             int inbar, outbar;
 
-            if ((inbar = (h * (long long) (ppp_in[i] + round)) / maxBytes)) {
-                g.setColor(fColorRecv);   /* h - 1 means bottom */
-                g.drawLine(i, h - 1, i, h - inbar);
+            long long in = ppp[i][PPP_IN], out = ppp[i][PPP_OUT];
+
+            if ((inbar = (h * (in + round)) / maxBytes)) {
+                /* h - 1 means bottom */
+                batch.drawLine(fColorRecv, i, h - 1, i, h - inbar);
             }
 
-            if ((outbar = (h * (long long) (ppp_out[i] + round)) / maxBytes)) {
-                g.setColor(fColorSend);   /* 0 means top */
-                g.drawLine(i, 0, i, outbar - 1);
+            if ((outbar = (h * (out + round)) / maxBytes)) {
+                /* 0 means top */
+                batch.drawLine(fColorSend, i, 0, i, outbar - 1);
             }
 
             if (inbar + outbar < h) {
@@ -382,13 +381,12 @@ void NetStatus::draw(Graphics &g) {
                  g.drawLine(i, l, i, t - l);
                  */
                 if (fColorIdle) {
-                    g.setColor(fColorIdle);
-                    g.drawLine(i, l, i, t);
+                    batch.drawLine(fColorIdle, i, l, i, t);
                 } else {
                     ref<YImage> gradient(getGradient());
 
                     if (gradient != null)
-                        g.drawImage(gradient,
+                        g.drawCached(gradient,
                                      x() + i, y() + l, width(), t - l, i, l);
                     else
                         if (taskbackPixmap != null)
@@ -398,13 +396,12 @@ void NetStatus::draw(Graphics &g) {
             }
         } else { /* Not reached: */
             if (fColorIdle) {
-                g.setColor(fColorIdle);
-                g.drawLine(i, 0, i, h - 1);
+                batch.drawLine(fColorIdle, i, 0, i, h - 1);
             } else {
                 ref<YImage> gradient(getGradient());
 
                 if (gradient != null)
-                    g.drawImage(gradient,
+                    g.drawCached(gradient,
                                  x() + i, y(), width(), h, i, 0);
                 else
                     if (taskbackPixmap != null)
@@ -477,22 +474,19 @@ void NetFreeDevice::getFlags() {
 void NetStatus::updateStatus(const char* sharedData) {
     int last = taskBarNetSamples - 1;
 
-    for (int i = 0; i < last; i++) {
-        ppp_in[i] = ppp_in[i + 1];
-        ppp_out[i] = ppp_out[i + 1];
-    }
-    getCurrent(&ppp_in[last], &ppp_out[last], sharedData);
+    ppp.rotate();
+    if (0 < last)
+        ppp.copyTo(last - 1, last);
+    getCurrent(&ppp[last][PPP_IN], &ppp[last][PPP_OUT], sharedData);
     /* These two lines clears first measurement; you can throw these lines
      * off, but bug will occur: on startup, the _second_ bar will show
      * always zero -stibor- */
     if (!wasUp)
-        ppp_in[last] = ppp_out[last] = 0;
+        ppp.clear(last);
 
     ++statusUpdateCount;
 
-    bool same = (0 < last &&
-                 ppp_in[last] == ppp_in[last - 1] &&
-                 ppp_out[last] == ppp_out[last - 1]);
+    bool same = 0 < last && 0 == ppp.compare(last, last - 1);
     unchanged = same ? 1 + unchanged : 0;
 
     repaint();
@@ -642,6 +636,7 @@ NetStatusControl::NetStatusControl(IApp* app, YSMListener* smActionListener,
     }
     interfaces.clear();
 
+    fUpdateTimer->setAligned();
     fUpdateTimer->setTimer(taskBarNetDelay, this, true);
 }
 
@@ -37,8 +37,8 @@ private:
     YColorName fColorSend;
     YColorName fColorIdle;
 
-    long *ppp_in; /* long could be really enough for rate in B/s */
-    long *ppp_out;
+    enum { PPP_IN, PPP_OUT, PPP_STATES };
+    YMulti<long> ppp; /* long could be really enough for rate in B/s */
 
     netbytes prev_ibytes, start_ibytes, cur_ibytes, offset_ibytes;
     netbytes prev_obytes, start_obytes, cur_obytes, offset_obytes;
@@ -160,7 +160,7 @@ void TrayApp::paint(Graphics &g, const YRect& r) {
     } else {
         if (width() > 0 && height() > 0) {
             if (bgGrad != null)
-                g.drawImage(bgGrad, sx, sy, width(), height(), 0, 0);
+                g.drawCached(bgGrad, sx, sy, width(), height(), 0, 0);
             else
             if (bgPix != null)
                 g.fillPixmap(bgPix, 0, 0, width(), height(), 0, 0);
@@ -389,9 +389,15 @@ cfoption icewm_preferences[] = {
     OBV("ShapesProtectClientWindow",            &protectClientWindow,           "Don't cut client windows by shapes set trough frame corner pixmap"),
 #endif
     OBV("DoubleBuffer",                         &doubleBuffer,                  "Use double buffering when redrawing the display"),
+    OBV("CompressMotionEvents",                 &compressMotionEvents,          "Handle only the last of queued pointer motions per window"),
+    OBV("CompressPropertyEvents",               &compressPropertyEvents,        "Handle only the last of queued property changes per window and property"),
+    OBV("CompressConfigureRequests",            &compressConfigureRequests,     "Merge queued configure requests of a window into one"),
+    OBV("CompressExposeEvents",                 &compressExposeEvents,          "Merge queued expose events of a window into one"),
     OBV("XRRDisable",                           &xrrDisable,                    "Disable use of new XRANDR API for dual head (nvidia workaround)"),
     OBV("PreferFreetypeFonts",                  &fontPreferFreetype,            "Favour Xft fonts over core X11 fonts where possible"),
     OIV("DelayFuzziness",                       &DelayFuzziness, 0, 100,        "Delay fuzziness in ms, to allow merging of multiple timer timeouts into one for notebook power saving"),
+    OIV("SamplingTick",                         &SamplingTick, 0, 60000,        "Align the periodic sampling of taskbar monitors to a shared tick of this many ms, to reduce wakeups, 0 to disable"),
+    OIV("SlowDispatchThreshold",                &SlowDispatchThreshold, 0, 60000, "Log any event, timer or poll dispatch which takes this many ms or longer, 0 to disable"),
     OIV("ClickMotionDistance",                  &ClickMotionDistance, 0, 32,    "Pointer motion distance before click gets interpreted as drag"),
     OIV("ClickMotionDelay",                     &ClickMotionDelay, 0, 2000,     "Delay in ms before click gets interpreted as drag"),
     OIV("MultiClickTime",                       &MultiClickTime, 0, 5000,       "Multiple click time in ms"),
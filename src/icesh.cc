@@ -2937,6 +2937,7 @@ bool IceSh::icewmAction()
         { "keys",       ICEWM_ACTION_RELOADKEYS },
         { "icewmbg",    ICEWM_ACTION_ICEWMBG },
         { "refresh",    ICEWM_ACTION_REFRESH },
+        { "latency",    ICEWM_ACTION_LATENCY },
     };
     for (Symbol sym : sa) {
         if (0 == strcmp(*argp, sym.name)) {
@@ -1197,6 +1197,7 @@ int main(int argc, char **argv) {
             }
             else if (is_long_switch(*arg, "verbose")) {
                 verbose = true;
+                YTrace::tracing("upload");
             }
             else if (is_long_switch(*arg, "sync")) {
                 YXApplication::synchronizeX11 = true;
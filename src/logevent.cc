@@ -21,10 +21,6 @@ const char* getAtomName(unsigned long atom) {
     return atomName ? atomName(atom) : "";
 }
 
-#if LOGEVENTS
-
-bool loggedEvents[LASTEvent];
-
 static const char eventNames[][17] = {
     "KeyPress",             //  2
     "KeyRelease",           //  3
@@ -67,6 +63,10 @@ const char* eventName(int eventType) {
     return "UnknownEvent!";
 }
 
+#if LOGEVENTS
+
+bool loggedEvents[LASTEvent];
+
 void setLogEvent(int evtype, bool enable) {
     if (size_t(evtype) < sizeof loggedEvents)
         loggedEvents[evtype] = enable;
@@ -420,14 +420,6 @@ void logRandrNotify(const XEvent& xev) {
 }
 #endif
 
-#else
-const char* eventName(int eventType) {
-    static char name[3];
-    name[0] = eventType / 10 % 10 + '0';
-    name[1] = eventType % 10 + '0';
-    name[2] = '\0';
-    return name;
-}
 #endif
 
 #if LOGEVENTS
@@ -405,6 +405,66 @@ static void test_refstr() {
     report(__func__);
 }
 
+static void test_multi() {
+    const int rows = 7, cols = 3;
+    YMulti<long> ring(rows, cols);
+    YMulti<long> flat(rows, cols);
+    ring.clear();
+    flat.clear();
+
+    // a ring must see the same rows as the shifting it replaces
+    for (int tick = 1; tick <= 3 * rows; ++tick) {
+        ring.rotate();
+        ring.clear(rows - 1);
+        for (int i = 1; i < rows; ++i)
+            flat.copyTo(i, i - 1);
+        flat.clear(rows - 1);
+        for (int j = 0; j < cols; ++j)
+            ring[rows - 1][j] = flat[rows - 1][j] = tick * cols + j;
+        for (int i = 0; i < rows; ++i) {
+            for (int j = 0; j < cols; ++j)
+                assert(ring[i][j] == flat[i][j]);
+            assert(ring.sum(i) == flat.sum(i));
+        }
+        assert(ring.compare(rows - 1, rows - 2) == +1);
+    }
+    ring.copyTo(rows - 2, rows - 1);
+    assert(ring.compare(rows - 1, rows - 2) == 0);
+
+    if (test_time) {
+        // one history per CPU, like the per-CPU taskbar applets
+        const int applets = 128, samples = 500, states = 8, ticks = 1000;
+        asmart<YMulti<long long>*> rings(new YMulti<long long>*[applets]);
+        for (int k = 0; k < applets; ++k) {
+            rings[k] = new YMulti<long long>(samples, states);
+            rings[k]->clear();
+        }
+        watch shift;
+        for (int t = 0; t < ticks; ++t) {
+            for (int k = 0; k < applets; ++k) {
+                for (int i = 1; i < samples; ++i)
+                    rings[k]->copyTo(i, i - 1);
+                (*rings[k])[samples - 1][0] = t;
+            }
+        }
+        double shifted = shift.delta();
+        watch rotate;
+        for (int t = 0; t < ticks; ++t) {
+            for (int k = 0; k < applets; ++k) {
+                rings[k]->rotate();
+                (*rings[k])[samples - 1][0] = t;
+            }
+        }
+        double rotated = rotate.delta();
+        for (int k = 0; k < applets; ++k)
+            delete rings[k];
+        printf("%d histories of %d samples, %d ticks: "
+               "shift %.6f, rotate %.6f seconds\n",
+               applets, samples, ticks, shifted, rotated);
+    }
+    report(__func__);
+}
+
 static void test_options(int argc, char** argv) {
     for (int i = 1; i < argc; ++i) {
         char* s = argv[i];
@@ -427,6 +487,7 @@ int main(int argc, char** argv) {
     test_str();
     test_mstr();
     test_refstr();
+    test_multi();
 
     return total != 0;
 }
@@ -0,0 +1,207 @@
+#include "config.h"
+#include "yxcontext.h"
+#include "base.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/Xresource.h>
+
+#define assert(a) if ((a) != 0) okays++; else bad(#a, __LINE__)
+
+char const *ApplicationName("testcontext");
+static bool test_time(false);
+static int fails;
+static int okays;
+static int total;
+
+static void bad(const char* str, int line) {
+    fails++;
+    printf("%s: test failed at line %d: %s\n", ApplicationName, line, str);
+}
+
+static void report(const char* mod) {
+    int done = fails + okays;
+    if (fails) {
+        printf("%s: %6s: %d/%d tests failed, %d/%d tests succeeded\n",
+                ApplicationName, mod+5, fails, done, okays, done);
+    } else {
+        printf("%s: %6s: %d/%d tests succeeded\n",
+                ApplicationName, mod+5, okays, done);
+    }
+    total += fails;
+    fails = okays = 0;
+}
+
+class watch {
+    double start;
+public:
+    double time() const {
+        timeval now;
+        gettimeofday(&now, 0);
+        return now.tv_sec + 1e-6 * now.tv_usec;
+    }
+    watch() : start(time()) {}
+    double delta() const { return time() - start; }
+};
+
+// window identifiers like an X server would hand them out
+static Window xid(int i) {
+    return 0x1200000UL + 5UL * i + (i & 3);
+}
+
+static void test_basic() {
+    YContext<int> context;
+    int values[3] = { 1, 2, 3 };
+
+    assert(context.find(xid(1)) == nullptr);
+    assert(context.remove(xid(1)) == false);
+    context.save(None, &values[0]);
+    assert(context.count() == 0);
+    assert(context.find(None) == nullptr);
+
+    context.save(xid(1), &values[0]);
+    context.save(xid(2), &values[1]);
+    assert(context.count() == 2);
+    assert(context.find(xid(1)) == &values[0]);
+    assert(context.find(xid(2)) == &values[1]);
+
+    context.save(xid(1), &values[2]);
+    assert(context.count() == 2);
+    assert(context.find(xid(1)) == &values[2]);
+
+    int* ptr = nullptr;
+    assert(context.find(xid(2), &ptr));
+    assert(ptr == &values[1]);
+    assert(context.find(xid(3), &ptr) == false);
+
+    assert(context.remove(xid(1)));
+    assert(context.find(xid(1)) == nullptr);
+    assert(context.find(xid(2)) == &values[1]);
+    assert(context.count() == 1);
+
+    report(__func__);
+}
+
+static void test_collide() {
+    const int n = 5000;
+    static int values[n];
+    YContext<int> context;
+
+    for (int i = 0; i < n; ++i)
+        context.save(xid(i), &values[i]);
+    assert(context.count() == unsigned(n));
+    int found = 0;
+    for (int i = 0; i < n; ++i)
+        found += context.find(xid(i)) == &values[i];
+    assert(found == n);
+
+    // remove in an order which exercises the backward shift
+    int removed = 0;
+    for (int i = 0; i < n; i += 3)
+        removed += context.remove(xid(i));
+    for (int i = 0; i < n; ++i) {
+        if (i % 3 == 0)
+            found -= context.find(xid(i)) == nullptr;
+        else
+            found -= context.find(xid(i)) == &values[i];
+    }
+    assert(found == 0);
+    assert(context.count() == unsigned(n - removed));
+
+    for (int i = n - 1; 0 <= i; --i)
+        context.remove(xid(i));
+    assert(context.count() == 0);
+    int missing = 0;
+    for (int i = 0; i < n; ++i)
+        missing += context.find(xid(i)) == nullptr;
+    assert(missing == n);
+
+    report(__func__);
+}
+
+// compare lookups against the XContext database of Xlib
+static void test_bench(Display* display, int n) {
+    const int rounds = 2000000 / n;
+    int* values = new int[n];
+    YContext<int> context;
+    XContext unique = XUniqueContext();
+
+    for (int i = 0; i < n; ++i)
+        context.save(xid(i), &values[i]);
+
+    int hits = 0;
+    watch mark;
+    for (int r = 0; r < rounds; ++r) {
+        for (int i = 0; i < n; ++i)
+            hits += context.find(xid(i)) == &values[i];
+    }
+    double ours = mark.delta();
+    assert(hits == rounds * n);
+
+    double theirs = 0;
+    if (display) {
+        for (int i = 0; i < n; ++i)
+            XSaveContext(display, xid(i), unique, (const char *) &values[i]);
+        watch xmark;
+        for (int r = 0; r < rounds; ++r) {
+            for (int i = 0; i < n; ++i) {
+                char* data = nullptr;
+                if (XFindContext(display, xid(i), unique, &data) == 0)
+                    hits -= data == (char *) &values[i];
+            }
+        }
+        theirs = xmark.delta();
+        assert(hits == 0);
+        for (int i = 0; i < n; ++i)
+            XDeleteContext(display, xid(i), unique);
+    }
+    delete[] values;
+
+    if (test_time) {
+        double lookups = double(rounds) * n;
+        if (display)
+            printf("%5d windows: YContext %.1f ns, XFindContext %.1f ns\n",
+                   n, 1e9 * ours / lookups, 1e9 * theirs / lookups);
+        else
+            printf("%5d windows: YContext %.1f ns\n",
+                   n, 1e9 * ours / lookups);
+    }
+}
+
+static void test_speed() {
+    // XFindContext needs a connection to a display
+    Display* display = test_time ? XOpenDisplay(nullptr) : nullptr;
+    test_bench(display, 100);
+    test_bench(display, 1000);
+    test_bench(display, 10000);
+    if (display)
+        XCloseDisplay(display);
+    report(__func__);
+}
+
+static void test_options(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        char* s = argv[i];
+        if (!strcmp(s, "-t") || !strcmp(s, "--time")) {
+            test_time = true;
+        }
+        else {
+            printf("invalid option: %s\n", s);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    test_options(argc, argv);
+
+    test_basic();
+    test_collide();
+    test_speed();
+
+    return total != 0;
+}
+
+// vim: set sw=4 ts=4 et:
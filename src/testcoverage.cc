@@ -0,0 +1,207 @@
+#include "config.h"
+#ifdef CONFIG_XFREETYPE
+#include "ycoverage.h"
+#include <fontconfig/fontconfig.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+#define assert(a) if ((a) != 0) okays++; else bad(#a, __LINE__)
+
+char const *ApplicationName("testcoverage");
+static bool test_time(false);
+static int fails;
+static int okays;
+static int total;
+
+static void bad(const char* str, int line) {
+    fails++;
+    printf("%s: test failed at line %d: %s\n", ApplicationName, line, str);
+}
+
+static void report(const char* mod) {
+    int done = fails + okays;
+    if (fails) {
+        printf("%s: %6s: %d/%d tests failed, %d/%d tests succeeded\n",
+                ApplicationName, mod+5, fails, done, okays, done);
+    } else {
+        printf("%s: %6s: %d/%d tests succeeded\n",
+                ApplicationName, mod+5, okays, done);
+    }
+    total += fails;
+    fails = okays = 0;
+}
+
+class watch {
+    double start;
+    char buf[42];
+public:
+    double time() const {
+        timeval now;
+        gettimeofday(&now, 0);
+        return now.tv_sec + 1e-6 * now.tv_usec;
+    }
+    watch() : start(time()) {}
+    double delta() const { return time() - start; }
+    const char* report() {
+        snprintf(buf, sizeof buf, "%.6f seconds", delta());
+        return buf;
+    }
+};
+
+#ifdef CONFIG_XFREETYPE
+
+static void add(FcCharSet* set, unsigned first, unsigned last) {
+    for (unsigned c = first; c <= last; ++c)
+        FcCharSetAddChar(set, c);
+}
+
+// roughly the repertoire of a latin, a CJK and an emoji font
+static FcCharSet* latinSet() {
+    FcCharSet* set = FcCharSetCreate();
+    add(set, 0x20, 0x7E);
+    add(set, 0xA0, 0x24F);
+    add(set, 0x2010, 0x2027);
+    return set;
+}
+
+static FcCharSet* cjkSet() {
+    FcCharSet* set = FcCharSetCreate();
+    add(set, 0x20, 0x7E);
+    add(set, 0x3000, 0x30FF);
+    add(set, 0x4E00, 0x9FFF);
+    add(set, 0xAC00, 0xD7A3);
+    add(set, 0xFF01, 0xFF60);
+    return set;
+}
+
+static FcCharSet* emojiSet() {
+    FcCharSet* set = FcCharSetCreate();
+    add(set, 0x2600, 0x27BF);
+    add(set, 0x1F300, 0x1F64F);
+    add(set, 0x1F680, 0x1F6FF);
+    for (unsigned c = 0x1F900; c <= 0x1F9FF; c += 3)
+        FcCharSetAddChar(set, c);
+    return set;
+}
+
+static void test_golden() {
+    FcCharSet* set = latinSet();
+    YCoverage cover(set);
+    assert(cover.has('A'));
+    assert(cover.has(' '));
+    assert(cover.has(0x2026));
+    assert(cover.has(0x1F) == false);
+    assert(cover.has(0x7F) == false);
+    assert(cover.has(0x4E2D) == false);
+    assert(cover.has(0x10FFFF) == false);
+    assert(cover.has(0x110000) == false);
+    assert(cover.has(~0U) == false);
+    FcCharSetDestroy(set);
+
+    YCoverage none(nullptr);
+    assert(none.has('A') == false);
+    assert(none.has(0) == false);
+
+    report(__func__);
+}
+
+static void test_compare() {
+    FcCharSet* sets[] = { latinSet(), cjkSet(), emojiSet() };
+    for (FcCharSet* set : sets) {
+        YCoverage cover(set);
+        bool same = true;
+        for (unsigned c = 0; c < 0x20000; ++c) {
+            if (cover.has(c) != bool(FcCharSetHasChar(set, c))) {
+                printf("code point %#x differs\n", c);
+                same = false;
+                break;
+            }
+        }
+        assert(same);
+        FcCharSetDestroy(set);
+    }
+    report(__func__);
+}
+
+// window titles of mixed scripts as UTF-32
+static const unsigned titles[][16] = {
+    { 0x65B0, 0x3057, 0x3044, 0x30BF, 0x30D6, ' ', '-', ' ',
+      'F', 'i', 'r', 'e', 'f', 'o', 'x', 0 },
+    { 0xD30C, 0xC77C, ' ', 0xAD00, 0xB9AC, 0xC790, ' ', 0x2014, ' ',
+      0x6587, 0x4EF6, 0x7BA1, 0x7406, 0x5668, 0 },
+    { 0x1F4E7, ' ', 'I', 'n', 'b', 'o', 'x', ' ', '(', '3', ')',
+      ' ', 0x1F600, 0x1F44D, 0x2728, 0 },
+    { 0x4F1A, 0x8B70, ' ', 0x1F3A4, ' ', 0x6E96, 0x5099, 0x4E2D,
+      0x2026, 0 },
+};
+
+static void benchmark(bool bitmaps, const int rounds) {
+    FcCharSet* sets[] = { latinSet(), cjkSet(), emojiSet() };
+    YCoverage* covers[] = {
+        new YCoverage(sets[0]), new YCoverage(sets[1]), new YCoverage(sets[2]),
+    };
+    const int count = 3;
+    long found = 0;
+    watch mark;
+    for (int r = 0; r < rounds; ++r) {
+        for (auto& title : titles) {
+            for (const unsigned* c = title; *c; ++c) {
+                // the first of the fallback fonts which has a glyph
+                int i = 0;
+                if (bitmaps) {
+                    while (i < count && covers[i]->has(*c) == false)
+                        ++i;
+                } else {
+                    while (i < count && FcCharSetHasChar(sets[i], *c) == 0)
+                        ++i;
+                }
+                found += i;
+            }
+        }
+    }
+    printf("%9s: %d titles, %ld fallbacks (%s)\n",
+           bitmaps ? "bitmaps" : "charsets", rounds * 4, found,
+           mark.report());
+    for (int i = 0; i < count; ++i) {
+        delete covers[i];
+        FcCharSetDestroy(sets[i]);
+    }
+}
+
+static void test_speed() {
+    if (test_time) {
+        benchmark(false, 1000000);
+        benchmark(true, 1000000);
+    }
+}
+
+#endif
+
+static void test_options(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        char* s = argv[i];
+        if (!strcmp(s, "-t") || !strcmp(s, "--time")) {
+            test_time = true;
+        }
+        else {
+            printf("invalid option: %s\n", s);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    test_options(argc, argv);
+
+#ifdef CONFIG_XFREETYPE
+    test_golden();
+    test_compare();
+    test_speed();
+#endif
+
+    return total != 0;
+}
+
+// vim: set sw=4 ts=4 et:
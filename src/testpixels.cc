@@ -0,0 +1,198 @@
+#include "config.h"
+#include "ypixels.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <X11/Xutil.h>
+
+#define assert(a) if ((a) != 0) okays++; else bad(#a, __LINE__)
+
+char const *ApplicationName("testpixels");
+static int fails;
+static int okays;
+static int total;
+
+static void bad(const char* str, int line) {
+    fails++;
+    printf("%s: test failed at line %d: %s\n", ApplicationName, line, str);
+}
+
+static void report(const char* mod) {
+    int done = fails + okays;
+    if (fails) {
+        printf("%s: %6s: %d/%d tests failed, %d/%d tests succeeded\n",
+                ApplicationName, mod+5, fails, done, okays, done);
+    } else {
+        printf("%s: %6s: %d/%d tests succeeded\n",
+                ApplicationName, mod+5, okays, done);
+    }
+    total += fails;
+    fails = okays = 0;
+}
+
+// a cheap reproducible pseudo random sequence
+static unsigned next(unsigned& seed) {
+    seed = seed * 1103515245U + 12345U;
+    return seed >> 8;
+}
+
+static const bool choices[] = { true, false };
+static const int depths[] = { 24, 32 };
+static const int orders[] = { LSBFirst, MSBFirst };
+
+static int hostOrder() {
+    const unsigned one = 1;
+    return *(const char *) &one ? LSBFirst : MSBFirst;
+}
+
+// an image without a display, with zeroed pixels
+class Image {
+public:
+    Image(int width, int height, int depth, int bpp, int order) {
+        memset(&image, 0, sizeof image);
+        image.width = width;
+        image.height = height;
+        image.depth = depth;
+        image.bits_per_pixel = bpp;
+        image.byte_order = order;
+        image.bitmap_bit_order = order;
+        if (depth == 1) {
+            image.format = XYBitmap;
+            image.bitmap_unit = image.bitmap_pad = 8;
+        } else {
+            image.format = ZPixmap;
+            image.bitmap_unit = image.bitmap_pad = 32;
+            image.red_mask = 0xFF0000;
+            image.green_mask = 0xFF00;
+            image.blue_mask = 0xFF;
+        }
+        XInitImage(&image);
+        image.data = (char *) calloc(image.bytes_per_line, height);
+    }
+    ~Image() { free(image.data); }
+
+    XImage* operator->() { return &image; }
+    operator XImage*() { return &image; }
+    bool operator==(const Image& other) const {
+        return memcmp(image.data, other.image.data,
+                      image.bytes_per_line * image.height) == 0;
+    }
+
+private:
+    XImage image;
+};
+
+static void randomize(XImage* image, unsigned seed, bool opaque) {
+    for (int j = 0; j < image->height; j++) {
+        uint32_t* row = (uint32_t *) (image->data + j * image->bytes_per_line);
+        for (int i = 0; i < image->width; i++) {
+            row[i] = (next(seed) << 16) ^ next(seed);
+            if (opaque)
+                row[i] |= 0x80000000U;
+        }
+    }
+}
+
+// compare the kernels, with and without SSE2, to XGetPixel and XPutPixel,
+// for every width up to 70, which leaves all lengths of scalar tails
+static void test_copy() {
+    for (bool simd : choices) {
+        pixelsUseSSE2 = simd;
+        bool same = true;
+        for (int depth : depths) {
+            for (int width = 1; width <= 70; ++width) {
+                Image source(width, 3, depth, 32, hostOrder());
+                randomize(source, width + depth, false);
+                for (int bpp : depths) {
+                    for (int order : orders) {
+                        if (bpp == 32 && order != hostOrder())
+                            continue;
+                        Image want(width, 3, depth, bpp, order);
+                        Image have(width, 3, depth, bpp, order);
+                        for (int j = 0; j < source->height; j++)
+                            for (int i = 0; i < width; i++)
+                                XPutPixel(want, i, j,
+                                          XGetPixel(source, i, j));
+                        same &= copyPixels(source, have);
+                        same &= (have == want);
+                    }
+                }
+            }
+        }
+        assert(same);
+    }
+    pixelsUseSSE2 = true;
+
+    Image source(8, 2, 32, 32, hostOrder());
+    Image planes(8, 2, 16, 16, hostOrder());
+    assert(copyPixels(source, planes) == false);
+
+    report(__func__);
+}
+
+static void test_mask() {
+    const int threshold = 10;
+    for (bool simd : choices) {
+        pixelsUseSSE2 = simd;
+        bool same = true;
+        for (int width = 1; width <= 70; ++width) {
+            Image source(width, 3, 32, 32, hostOrder());
+            randomize(source, width, false);
+            // put some alphas around the threshold
+            uint32_t* row = (uint32_t *) source->data;
+            for (int i = 0; i < width; i++)
+                row[i] = (row[i] & 0xFFFFFF) | uint32_t(i % 20) << 24;
+            for (bool masked : choices) {
+                for (int order : orders) {
+                    Image want(width, 3, 1, 1, order);
+                    Image have(width, 3, 1, 1, order);
+                    for (int j = 0; j < source->height; j++)
+                        for (int i = 0; i < width; i++)
+                            XPutPixel(want, i, j, !masked ||
+                                ((XGetPixel(source, i, j) >> 24) & 0xff)
+                                >= threshold);
+                    thresholdMask(source, have, masked, threshold);
+                    same &= (have == want);
+                }
+            }
+        }
+        assert(same);
+    }
+    pixelsUseSSE2 = true;
+    report(__func__);
+}
+
+static void test_translucent() {
+    for (bool simd : choices) {
+        pixelsUseSSE2 = simd;
+        bool same = true;
+        for (int width = 1; width <= 70; ++width) {
+            Image source(width, 3, 32, 32, hostOrder());
+            randomize(source, width, true);
+            same &= (translucentPixels(source) == false);
+            // one translucent pixel at every position of the last row
+            for (int i = 0; i < width; i++) {
+                uint32_t* row = (uint32_t *)
+                    (source->data + 2 * source->bytes_per_line);
+                uint32_t keep = row[i];
+                row[i] &= 0x7FFFFFFFU;
+                same &= translucentPixels(source);
+                row[i] = keep;
+            }
+        }
+        assert(same);
+    }
+    pixelsUseSSE2 = true;
+    report(__func__);
+}
+
+int main(int argc, char** argv) {
+    test_copy();
+    test_mask();
+    test_translucent();
+
+    return total != 0;
+}
+
+// vim: set sw=4 ts=4 et:
@@ -0,0 +1,247 @@
+#include "config.h"
+#include "yscale.h"
+#include "ypointer.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+#define assert(a) if ((a) != 0) okays++; else bad(#a, __LINE__)
+
+char const *ApplicationName("testscale");
+static bool test_time(false);
+static int fails;
+static int okays;
+static int total;
+
+static void bad(const char* str, int line) {
+    fails++;
+    printf("%s: test failed at line %d: %s\n", ApplicationName, line, str);
+}
+
+static void report(const char* mod) {
+    int done = fails + okays;
+    if (fails) {
+        printf("%s: %6s: %d/%d tests failed, %d/%d tests succeeded\n",
+                ApplicationName, mod+5, fails, done, okays, done);
+    } else {
+        printf("%s: %6s: %d/%d tests succeeded\n",
+                ApplicationName, mod+5, okays, done);
+    }
+    total += fails;
+    fails = okays = 0;
+}
+
+class watch {
+    double start;
+    char buf[42];
+public:
+    double time() const {
+        timeval now;
+        gettimeofday(&now, 0);
+        return now.tv_sec + 1e-6 * now.tv_usec;
+    }
+    watch() : start(time()) {}
+    double delta() const { return time() - start; }
+    const char* report() {
+        snprintf(buf, sizeof buf, "%.6f seconds", delta());
+        return buf;
+    }
+};
+
+// a cheap reproducible pseudo random sequence
+static unsigned next(unsigned& seed) {
+    seed = seed * 1103515245U + 12345U;
+    return seed >> 8;
+}
+
+static void randomize(uint32_t* pixels, unsigned count, unsigned seed) {
+    for (unsigned i = 0; i < count; ++i)
+        pixels[i] = (next(seed) << 16) ^ next(seed);
+}
+
+// the exact area weighted average of one channel
+static double average(const uint32_t* source, unsigned w, unsigned h,
+                      unsigned nw, unsigned nh, unsigned k, unsigned l,
+                      int channel)
+{
+    double x0 = double(k) * w / nw, x1 = double(k + 1) * w / nw;
+    double y0 = double(l) * h / nh, y1 = double(l + 1) * h / nh;
+    double sum = 0, area = 0;
+    for (unsigned j = unsigned(y0); j < h && j < y1; ++j) {
+        double dy = (j + 1 < y1 ? j + 1 : y1) - (j > y0 ? j : y0);
+        for (unsigned i = unsigned(x0); i < w && i < x1; ++i) {
+            double dx = (i + 1 < x1 ? i + 1 : x1) - (i > x0 ? i : x0);
+            sum += dx * dy * ((source[j * w + i] >> (8 * channel)) & 0xFF);
+            area += dx * dy;
+        }
+    }
+    return sum / area;
+}
+
+// whether every channel is within one of the exact average
+static bool close(const uint32_t* source, unsigned w, unsigned h,
+                  const uint32_t* target, unsigned nw, unsigned nh)
+{
+    for (unsigned l = 0; l < nh; ++l) {
+        for (unsigned k = 0; k < nw; ++k) {
+            for (int c = 0; c < 4; ++c) {
+                double want = average(source, w, h, nw, nh, k, l, c);
+                int have = (target[l * nw + k] >> (8 * c)) & 0xFF;
+                if (have < want - 1.0 || have > want + 1.0) {
+                    printf("%ux%u to %ux%u at %u,%u channel %d: "
+                           "%d instead of %.3f\n",
+                           w, h, nw, nh, k, l, c, have, want);
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+static void test_golden() {
+    // thirds: weights of 2/3 and 1/3
+    const uint32_t row[3] = { 0xFF000000, 0xFF5A5A5A, 0xFFB4B4B4 };
+    uint32_t half[2];
+    boxScale(row, 3, 1, 3, half, 2, 1, 2);
+    assert(half[0] == 0xFF1E1E1E);
+    assert(half[1] == 0xFF969696);
+
+    // quarters of a checker board round half up
+    const uint32_t checker[4] = {
+        0x00000000, 0xFFFFFFFF,
+        0xFFFFFFFF, 0x00000000,
+    };
+    uint32_t one = 0;
+    boxScale(checker, 2, 2, 2, &one, 1, 1, 1);
+    assert(one == 0x80808080);
+
+    // enlarging by a whole factor replicates pixels
+    const uint32_t quad[4] = {
+        0xFF102030, 0x80405060,
+        0x00708090, 0xC0A0B0C0,
+    };
+    uint32_t big[36];
+    boxScale(quad, 2, 2, 2, big, 6, 6, 6);
+    bool same = true;
+    for (unsigned l = 0; l < 6; ++l)
+        for (unsigned k = 0; k < 6; ++k)
+            same &= big[l * 6 + k] == quad[(l / 3) * 2 + k / 3];
+    assert(same);
+
+    // one and a half times mixes neighbours halfway
+    uint32_t wide[3];
+    const uint32_t pair[2] = { 0x00000000, 0xFFC8643C };
+    boxScale(pair, 2, 1, 2, wide, 3, 1, 3);
+    assert(wide[0] == 0x00000000);
+    assert(wide[1] == 0x8064321E);
+    assert(wide[2] == 0xFFC8643C);
+
+    // a uniform color stays the same at any size
+    uint32_t plain[35 * 19];
+    for (unsigned i = 0; i < 35 * 19; ++i)
+        plain[i] = 0xA1B2C3D4;
+    uint32_t out[48 * 48];
+    const unsigned sizes[][2] = { {1, 1}, {7, 3}, {35, 19}, {48, 48}, {17, 40} };
+    for (auto& size : sizes) {
+        boxScale(plain, 35, 19, 35, out, size[0], size[1], size[0]);
+        bool uniform = true;
+        for (unsigned i = 0; i < size[0] * size[1]; ++i)
+            uniform &= out[i] == 0xA1B2C3D4;
+        assert(uniform);
+    }
+
+    // the identity keeps every pixel
+    uint32_t noise[37 * 23], copy[37 * 23];
+    randomize(noise, 37 * 23, 7);
+    boxScale(noise, 37, 23, 37, copy, 37, 23, 37);
+    assert(memcmp(noise, copy, sizeof noise) == 0);
+
+    report(__func__);
+}
+
+static void test_average() {
+    const unsigned cases[][4] = {
+        { 16, 16, 48, 48 },
+        { 48, 48, 16, 16 },
+        { 48, 48, 20, 20 },
+        { 32, 32, 24, 24 },
+        { 22, 22, 64, 64 },
+        { 100, 7, 13, 29 },
+        { 13, 29, 100, 7 },
+        { 640, 480, 33, 17 },
+    };
+    for (auto& c : cases) {
+        asmart<uint32_t> source(new uint32_t[c[0] * c[1]]);
+        asmart<uint32_t> target(new uint32_t[c[2] * c[3]]);
+        randomize(source, c[0] * c[1], c[0] * 31 + c[3]);
+        boxScale(source, c[0], c[1], c[0], target, c[2], c[3], c[2]);
+        assert(close(source, c[0], c[1], target, c[2], c[3]));
+    }
+
+    // strides differ from the width
+    uint32_t wider[20 * 10], small[5 * 4];
+    randomize(wider, 20 * 10, 11);
+    uint32_t packed[12 * 10];
+    for (unsigned j = 0; j < 10; ++j)
+        memcpy(packed + j * 12, wider + j * 20, 12 * sizeof(uint32_t));
+    uint32_t outer[8 * 4];
+    boxScale(wider, 12, 10, 20, outer, 5, 4, 8);
+    boxScale(packed, 12, 10, 12, small, 5, 4, 5);
+    bool strided = true;
+    for (unsigned l = 0; l < 4; ++l)
+        strided &= memcmp(small + l * 5, outer + l * 8, 20) == 0;
+    assert(strided);
+
+    report(__func__);
+}
+
+static void benchmark(unsigned w, unsigned h, unsigned nw, unsigned nh,
+                      int rounds)
+{
+    asmart<uint32_t> source(new uint32_t[w * h]);
+    asmart<uint32_t> target(new uint32_t[nw * nh]);
+    randomize(source, w * h, w + h);
+    watch mark;
+    for (int i = 0; i < rounds; ++i)
+        boxScale(source, w, h, w, target, nw, nh, nw);
+    printf("%5dx %4ux%-4u to %4ux%-4u (%s)\n",
+           rounds, w, h, nw, nh, mark.report());
+}
+
+static void test_speed() {
+    if (test_time) {
+        benchmark(16, 16, 48, 48, 10000);
+        benchmark(48, 48, 16, 16, 10000);
+        benchmark(128, 128, 48, 48, 1000);
+        benchmark(1920, 1080, 3840, 2160, 4);
+        benchmark(3840, 2160, 1920, 1080, 4);
+        benchmark(3840, 2160, 2560, 1440, 4);
+        benchmark(2560, 1600, 3840, 2160, 4);
+    }
+}
+
+static void test_options(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        char* s = argv[i];
+        if (!strcmp(s, "-t") || !strcmp(s, "--time")) {
+            test_time = true;
+        }
+        else {
+            printf("invalid option: %s\n", s);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    test_options(argc, argv);
+
+    test_golden();
+    test_average();
+    test_speed();
+
+    return total != 0;
+}
+
+// vim: set sw=4 ts=4 et:
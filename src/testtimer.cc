@@ -0,0 +1,392 @@
+#include "config.h"
+#include "yapp.h"
+#include "ytimer.h"
+#include "yprefs.h"
+#include "ywork.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define assert(a) if ((a) != 0) okays++; else bad(#a, __LINE__)
+
+char const *ApplicationName("testtimer");
+static bool test_time(false);
+static int fails;
+static int okays;
+static int total;
+
+static void bad(const char* str, int line) {
+    fails++;
+    printf("%s: test failed at line %d: %s\n", ApplicationName, line, str);
+}
+
+static void report(const char* mod) {
+    int done = fails + okays;
+    if (fails) {
+        printf("%s: %6s: %d/%d tests failed, %d/%d tests succeeded\n",
+                ApplicationName, mod+5, fails, done, okays, done);
+    } else {
+        printf("%s: %6s: %d/%d tests succeeded\n",
+                ApplicationName, mod+5, okays, done);
+    }
+    total += fails;
+    fails = okays = 0;
+}
+
+class watch {
+    double start;
+    char buf[42];
+public:
+    double time() const {
+        timeval now;
+        gettimeofday(&now, 0);
+        return now.tv_sec + 1e-6 * now.tv_usec;
+    }
+    watch() : start(time()) {}
+    double delta() const { return time() - start; }
+    const char* report() {
+        snprintf(buf, sizeof buf, "%.6f seconds", delta());
+        return buf;
+    }
+};
+
+static const int N = 10000;
+
+// a cheap reproducible pseudo random sequence
+static unsigned next(unsigned& seed) {
+    seed = seed * 1103515245U + 12345U;
+    return seed >> 8;
+}
+
+class TimerTest: public YApplication, public YTimerListener {
+public:
+    TimerTest(int *argc, char ***argv):
+        YApplication(argc, argv),
+        timers(new YTimer[N]),
+        fired(0),
+        stolen(0),
+        early(0),
+        disorder(0),
+        previous(zerotime())
+    { }
+
+    void start(unsigned seed, long range) {
+        fired = stolen = early = disorder = 0;
+        previous = zerotime();
+        for (int i = 0; i < N; ++i)
+            timers[i].setTimer(long(next(seed) % range), this, true);
+    }
+
+    // expect all timers to expire, except for those which were stopped
+    int run() {
+        mainLoop();
+        return fired + stolen;
+    }
+
+    virtual bool handleTimer(YTimer* timer) {
+        timeval now = monotime();
+        if (now < timer->timeout_min())
+            early++;
+        if (timer->timeout_min() < previous)
+            disorder++;
+        previous = timer->timeout_min();
+        ++fired;
+        // stop some other running timer now and then
+        int k = int(timer - &timers[0]);
+        if (k % 7 == 0) {
+            YTimer* other = &timers[(k * 13 + 5) % N];
+            if (other->isRunning()) {
+                other->stopTimer();
+                ++stolen;
+            }
+        }
+        if (fired + stolen == N)
+            exitLoop(0);
+        return false;
+    }
+
+    asmart<YTimer> timers;
+    int fired, stolen, early, disorder;
+    timeval previous;
+};
+
+static void test_order(TimerTest& app) {
+    int fuzz = DelayFuzziness;
+    DelayFuzziness = 0;
+
+    watch mark;
+    app.start(1, 200);
+    assert(app.run() == N);
+    assert(app.fired > N / 2);
+    assert(app.early == 0);
+    assert(app.disorder == 0);
+    for (int i = 0; i < N; ++i)
+        assert(app.timers[i].isRunning() == false);
+
+    DelayFuzziness = fuzz;
+    if (test_time)
+        printf("expired %d exact timers (%s)\n", app.fired, mark.report());
+    report(__func__);
+}
+
+static void test_fuzzy(TimerTest& app) {
+    int fuzz = DelayFuzziness;
+    DelayFuzziness = 50;
+
+    watch mark;
+    app.start(2, 200);
+    assert(app.run() == N);
+    assert(app.early == 0);
+    for (int i = 0; i < N; ++i)
+        assert(app.timers[i].isRunning() == false);
+
+    DelayFuzziness = fuzz;
+    if (test_time)
+        printf("expired %d fuzzy timers (%s)\n", app.fired, mark.report());
+    report(__func__);
+}
+
+static void test_schedule(TimerTest& app) {
+    unsigned seed = 3;
+    YTimer* timers = &app.timers[0];
+
+    watch mark;
+    for (int i = 0; i < N; ++i)
+        timers[i].setTimer(long(1000 + next(seed) % 9000), &app, true);
+    double started = mark.delta();
+
+    // restarting a running timer moves it within the queue
+    for (int round = 0; round < 10; ++round) {
+        for (int i = 0; i < N; ++i)
+            timers[i].startTimer(long(1000 + next(seed) % 9000));
+    }
+    double restarted = mark.delta() - started;
+
+    for (int i = 0; i < N; i += 2)
+        timers[i].stopTimer();
+    for (int i = 1; i < N; i += 2)
+        assert(timers[i].isRunning());
+    for (int i = N - 1; 0 <= i; --i)
+        timers[i].stopTimer();
+    double stopped = mark.delta() - started - restarted;
+
+    for (int i = 0; i < N; ++i)
+        assert(timers[i].isRunning() == false);
+
+    if (test_time)
+        printf("%d timers: start %.6f, 10x restart %.6f, stop %.6f seconds\n",
+               N, started, restarted, stopped);
+    report(__func__);
+}
+
+static void test_aligned(TimerTest& app) {
+    int tick = SamplingTick;
+    SamplingTick = 100;
+
+    // aligned timers expire on common ticks, whatever their start
+    const int count = 8;
+    YTimer aligned[count];
+    unsigned seed = 4;
+    timeval start = monotime();
+    for (int i = 0; i < count; ++i) {
+        aligned[i].setAligned();
+        aligned[i].setTimer(long(200 + next(seed) % 800), &app, true);
+        usleep(1000 + next(seed) % 5000);
+    }
+    for (int i = 0; i < count; ++i) {
+        assert(aligned[i].isAligned());
+        assert(start < aligned[i].timeout());
+        timeval diff = aligned[i].timeout() - aligned[0].timeout();
+        long micros = diff.tv_sec * 1000000L + diff.tv_usec;
+        assert(micros % 100000L == 0);
+        aligned[i].stopTimer();
+    }
+
+    SamplingTick = tick;
+    report(__func__);
+}
+
+class TestJob: public YJob {
+public:
+    TestJob(TimerTest& app, int& count, int& wrong, int expect):
+        app(app), count(count), wrong(wrong), expect(expect),
+        main(pthread_self()), worker(main)
+    { }
+
+    virtual void run() {
+        worker = pthread_self();
+        usleep(100);
+    }
+
+    virtual void done() {
+        if (pthread_equal(main, pthread_self()) == 0 ||
+            pthread_equal(main, worker) != 0)
+            ++wrong;
+        if (++count == expect)
+            app.exitLoop(0);
+    }
+
+private:
+    TimerTest& app;
+    int& count;
+    int& wrong;
+    int expect;
+    pthread_t main;
+    pthread_t worker;
+};
+
+// a listener which immediately runs its own timer again
+class Rerun: public YTimerListener {
+public:
+    enum { Limit = 10000000 };
+    Rerun(TimerTest& app) : app(app), runs(0),
+        again(1000, this, false), stop(50, this, false, true) { }
+    virtual bool handleTimer(YTimer* timer) {
+        if (timer == &stop) {
+            app.exitLoop(0);
+        } else if (++runs < Limit) {
+            again.runTimer();
+        }
+        return false;
+    }
+    TimerTest& app;
+    int runs;
+    YTimer again, stop;
+};
+
+static void test_rerun(TimerTest& app) {
+    // a fuzzy timer which runs now must not expire before now
+    int fuzz = DelayFuzziness;
+    DelayFuzziness = 50;
+
+    Rerun rerun(app);
+    rerun.again.runTimer();
+    rerun.stop.startTimer();
+
+    // the timer runs once per pass, which lets the other timer expire
+    watch mark;
+    app.mainLoop();
+    assert(rerun.stop.isRunning() == false);
+    assert(rerun.runs > 1);
+    assert(rerun.runs < Rerun::Limit);
+    rerun.again.stopTimer();
+
+    DelayFuzziness = fuzz;
+    if (test_time)
+        printf("reran a timer %d times (%s)\n", rerun.runs, mark.report());
+    report(__func__);
+}
+
+static void test_jobs(TimerTest& app) {
+    const int jobs = 64;
+    int count = 0, wrong = 0, cancelled = 0;
+    int expect = jobs - jobs / 4;
+
+    watch mark;
+    for (int i = 0; i < jobs; ++i) {
+        YJob* job = new TestJob(app, count, wrong, expect);
+        mainLoop->submitJob(job);
+        if (i % 4 == 3)
+            cancelled += mainLoop->cancelJob(job);
+    }
+    assert(cancelled == jobs / 4);
+    app.mainLoop();
+    assert(count == expect);
+    assert(wrong == 0);
+
+    if (test_time)
+        printf("completed %d jobs (%s)\n", count, mark.report());
+    report(__func__);
+}
+
+// the progress of a slow job, as seen from the main thread
+class Progress {
+public:
+    enum State { Queued, Started, Released, Finished };
+    Progress() : state(Queued) { pthread_mutex_init(&mutex, nullptr); }
+    ~Progress() { pthread_mutex_destroy(&mutex); }
+
+    State get() {
+        pthread_mutex_lock(&mutex);
+        State now = state;
+        pthread_mutex_unlock(&mutex);
+        return now;
+    }
+    void set(State next) {
+        pthread_mutex_lock(&mutex);
+        state = next;
+        pthread_mutex_unlock(&mutex);
+    }
+    // poll for a state, but give up after about five seconds
+    bool await(State want) {
+        for (int i = 0; i < 500 && get() != want; ++i)
+            usleep(10000);
+        return get() == want;
+    }
+
+private:
+    pthread_mutex_t mutex;
+    State state;
+};
+
+// a job which blocks like a slow name server until it is released
+class SlowJob: public YJob {
+public:
+    SlowJob(Progress& progress) : progress(progress) { }
+    virtual void run() {
+        progress.set(Progress::Started);
+        progress.await(Progress::Released);
+    }
+    virtual void done() { }
+    ~SlowJob() { progress.set(Progress::Finished); }
+private:
+    Progress& progress;
+};
+
+static void test_shutdown(TimerTest& app) {
+    static Progress progress;
+    YWorkerPool* pool = new YWorkerPool();
+    pool->submit(new SlowJob(progress));
+    assert(progress.await(Progress::Started));
+
+    // a running job is not waited for
+    delete pool;
+    assert(progress.get() == Progress::Started);
+
+    // but deleted by its worker when it ends
+    progress.set(Progress::Released);
+    assert(progress.await(Progress::Finished));
+
+    report(__func__);
+}
+
+static void test_options(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        char* s = argv[i];
+        if (!strcmp(s, "-t") || !strcmp(s, "--time")) {
+            test_time = true;
+        }
+        else {
+            printf("invalid option: %s\n", s);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    test_options(argc, argv);
+
+    TimerTest app(&argc, &argv);
+    test_order(app);
+    test_fuzzy(app);
+    test_schedule(app);
+    test_aligned(app);
+    test_rerun(app);
+    test_jobs(app);
+    test_shutdown(app);
+
+    return total != 0;
+}
+
+// vim: set sw=4 ts=4 et:
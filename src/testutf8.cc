@@ -0,0 +1,325 @@
+#include "config.h"
+#include "ylocale.h"
+#include "base.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <iconv.h>
+#include <sys/time.h>
+
+#define assert(a) if ((a) != 0) okays++; else bad(#a, __LINE__)
+
+char const *ApplicationName("testutf8");
+static bool test_time(false);
+static int fails;
+static int okays;
+static int total;
+
+static void bad(const char* str, int line) {
+    fails++;
+    printf("%s: test failed at line %d: %s\n", ApplicationName, line, str);
+}
+
+static void report(const char* mod) {
+    int done = fails + okays;
+    if (fails) {
+        printf("%s: %6s: %d/%d tests failed, %d/%d tests succeeded\n",
+                ApplicationName, mod+5, fails, done, okays, done);
+    } else {
+        printf("%s: %6s: %d/%d tests succeeded\n",
+                ApplicationName, mod+5, okays, done);
+    }
+    total += fails;
+    fails = okays = 0;
+}
+
+class watch {
+    double start;
+    char buf[42];
+public:
+    double time() const {
+        timeval now;
+        gettimeofday(&now, 0);
+        return now.tv_sec + 1e-6 * now.tv_usec;
+    }
+    watch() : start(time()) {}
+    double delta() const { return time() - start; }
+    const char* report() {
+        snprintf(buf, sizeof buf, "%.6f seconds", delta());
+        return buf;
+    }
+};
+
+#ifdef CONFIG_I18N
+
+static iconv_t toUnicode, toLocale;
+
+// the conversions as they are done by iconv
+static size_t iconvUnicode(const char* str, size_t len, wchar_t* out) {
+    iconv(toUnicode, nullptr, nullptr, nullptr, nullptr);
+    char* inbuf = const_cast<char *>(str);
+    char* outbuf = (char *) out;
+    size_t inlen = len, outlen = 4 * len;
+    errno = 0;
+    iconv(toUnicode, &inbuf, &inlen, &outbuf, &outlen);
+    return (wchar_t *) outbuf - out;
+}
+
+static size_t iconvLocale(const wchar_t* str, size_t len, char* out) {
+    iconv(toLocale, nullptr, nullptr, nullptr, nullptr);
+    char* inbuf = (char *) str;
+    char* outbuf = out;
+    size_t inlen = len * sizeof(wchar_t), outlen = 4 * len;
+    iconv(toLocale, &inbuf, &inlen, &outbuf, &outlen);
+    return outbuf - out;
+}
+
+// whether a UTF-8 string decodes the same as by iconv, with the same error
+static bool sameUnicode(const char* str, size_t len) {
+    wchar_t* want = new wchar_t[len + 1];
+    size_t wlen = iconvUnicode(str, len, want);
+    int werr = errno;
+    size_t ulen = 0;
+    wchar_t* have = YLocale::unicodeString(str, len, ulen);
+    int uerr = errno;
+    bool same = (ulen == wlen && memcmp(have, want, ulen * sizeof(wchar_t)) == 0
+                 && have[ulen] == 0 && uerr == werr);
+    if (same == false) {
+        printf("decoding %zu bytes gives %zu instead of %zu characters, "
+               "error %d instead of %d\n", len, ulen, wlen, uerr, werr);
+    }
+    delete[] want;
+    delete[] have;
+    return same;
+}
+
+// whether a wide string encodes the same as by iconv
+static bool sameLocale(const wchar_t* str, size_t len) {
+    char* want = new char[4 * len + 1];
+    size_t wlen = iconvLocale(str, len, want);
+    size_t llen = 0;
+    char* have = YLocale::localeString(str, len, llen);
+    bool same = (llen == wlen && memcmp(have, want, llen) == 0
+                 && have[llen] == '\0');
+    if (same == false) {
+        printf("encoding %zu characters gives %zu instead of %zu bytes\n",
+               len, llen, wlen);
+    }
+    delete[] want;
+    delete[] have;
+    return same;
+}
+
+static const char* const titles[] = {
+    "xterm",
+    "Terminal - user@host: ~/src/icewm/src",
+    "Mozilla Firefox - Start Page - The quick brown fox jumps over",
+    "Gr\xc3\xbc\xc3\x9f" "e aus M\xc3\xbcnchen \xe2\x80\x94 Editor",
+    "\xe6\x96\xb0\xe3\x81\x97\xe3\x81\x84\xe3\x82\xbf\xe3\x83\x96 - Firefox",
+    "\xd0\x9f\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82, \xd0\xbc\xd0\xb8\xd1\x80",
+    "\xf0\x9f\x93\xa7 Inbox (3) - mail.example.org \xf0\x9f\x98\x80",
+    "\xd7\xa9\xd7\x9c\xd7\x95\xd7\x9d 0123456789abcdef0123456789abcdef",
+    "0123456789abcdef\xc2\xa9" "0123456789abcdef0123456789abcdef\xe2\x82\xac",
+    "",
+};
+
+static void test_valid() {
+    for (const char* title : titles) {
+        assert(sameUnicode(title, strlen(title)));
+    }
+
+    // every code point in order, around the boundaries of the encodings
+    const unsigned ranges[][2] = {
+        { 1, 0x7FF }, { 0xF000, 0xFFFF }, { 0x10000, 0x10400 },
+        { 0x10FF00, 0x10FFFF },
+    };
+    for (auto& range : ranges) {
+        size_t count = range[1] - range[0] + 1;
+        wchar_t* wide = new wchar_t[count];
+        for (size_t i = 0; i < count; ++i)
+            wide[i] = wchar_t(range[0] + i);
+        assert(sameLocale(wide, count));
+
+        char* utf8 = new char[4 * count + 1];
+        size_t len = iconvLocale(wide, count, utf8);
+        assert(sameUnicode(utf8, len));
+        delete[] utf8;
+        delete[] wide;
+    }
+
+    // all ASCII at every alignment
+    char ascii[128];
+    for (int i = 0; i < 127; ++i)
+        ascii[i] = char(i + 1);
+    bool aligned = true;
+    for (int i = 0; i < 40; ++i)
+        aligned &= sameUnicode(ascii + i, 127 - 2 * i);
+    assert(aligned);
+
+    wchar_t wide[128];
+    for (int i = 0; i < 128; ++i)
+        wide[i] = wchar_t(i);
+    aligned = true;
+    for (int i = 0; i < 40; ++i)
+        aligned &= sameLocale(wide + i, 128 - 2 * i);
+    assert(aligned);
+
+    report(__func__);
+}
+
+static void test_malformed() {
+    const char* const broken[] = {
+        "abc\xc0\xaf" "def",                // overlong slash
+        "abc\xe0\x80\xaf" "def",            // overlong in three bytes
+        "abc\xf0\x80\x80\xaf" "def",        // overlong in four bytes
+        "abc\xed\xa0\x80" "def",            // surrogate
+        "abc\x80" "def",                    // lone continuation
+        "abc\xbf\xbf" "def",
+        "abc\xe2\x80" "def",                // cut short
+        "abc\xe2\x80",                      // incomplete at the end
+        "abc\xf0\x9f\x98",
+        "abc\xc3",
+        "abc\xc0",                          // cut short and overlong
+        "abc\xe0\x80",
+        "abc\xed\xa0",                      // cut short surrogate
+        "abc\xf4\x90",                      // cut short beyond Unicode
+        "abc\xf5\x80\x80",
+        "abc\xf8\x88\x80\x80",              // cut short longer forms
+        "abc\xfc\x84\x80",
+        "abc\xfe\xff" "def",                // never valid
+        "0123456789abcdef0123\xff" "456789abcdef",
+        "\xe6\x96\xb0\xe3\x81" "0123456789abcdef",
+    };
+    for (const char* str : broken) {
+        assert(sameUnicode(str, strlen(str)));
+    }
+
+    // code points beyond Unicode are rejected, unlike by glibc
+    const char big[] = "abc\xf4\x90\x80\x80" "def";
+    size_t ulen = 0;
+    wchar_t* have = YLocale::unicodeString(big, strlen(big), ulen);
+    assert(ulen == 3);
+    assert(errno == EILSEQ);
+    delete[] have;
+
+    // surrogates become question marks as with transliteration
+    const wchar_t lone[] = { 'a', 0xD800, 'b', 0xDFFF, 'c' };
+    assert(sameLocale(lone, 5));
+
+    report(__func__);
+}
+
+// a cheap reproducible pseudo random sequence
+static unsigned next(unsigned& seed) {
+    seed = seed * 1103515245U + 12345U;
+    return seed >> 8;
+}
+
+static void test_random() {
+    unsigned seed = 42;
+    bool same = true;
+    for (int round = 0; round < 2000 && same; ++round) {
+        // mostly valid text with some random bytes
+        char str[200];
+        size_t len = 0;
+        size_t want = next(seed) % 120;
+        while (len < want) {
+            unsigned pick = next(seed) % 100;
+            if (pick < 60) {
+                str[len++] = char(' ' + next(seed) % 95);
+            } else if (pick < 97) {
+                wchar_t c = wchar_t(0x80 + next(seed) % 0x1FF80);
+                if (0xD800 <= c && c <= 0xDFFF)
+                    continue;
+                len += iconvLocale(&c, 1, str + len);
+            } else {
+                str[len++] = char(next(seed));
+            }
+        }
+        wchar_t* wide = new wchar_t[len + 1];
+        size_t wlen = iconvUnicode(str, len, wide);
+        bool beyond = false;
+        for (size_t i = 0; i < wlen; ++i)
+            beyond |= (wide[i] > 0x10FFFF);
+        if (beyond == false) {
+            same &= sameUnicode(str, len);
+            same &= sameLocale(wide, wlen);
+        }
+        delete[] wide;
+    }
+    assert(same);
+
+    report(__func__);
+}
+
+static void benchmark(bool native, int rounds) {
+    size_t count = 0;
+    watch mark;
+    for (int r = 0; r < rounds; ++r) {
+        for (const char* title : titles) {
+            size_t len = strlen(title), ulen = 0;
+            wchar_t* wide;
+            if (native) {
+                wide = YLocale::unicodeString(title, len, ulen);
+            } else {
+                wide = new wchar_t[len + 1];
+                ulen = iconvUnicode(title, len, wide);
+            }
+            count += ulen;
+            delete[] wide;
+        }
+    }
+    printf("%7s: %d titles, %zu characters (%s)\n",
+           native ? "native" : "iconv", rounds * int ACOUNT(titles),
+           count, mark.report());
+}
+
+static void test_speed() {
+    if (test_time) {
+        benchmark(false, 200000);
+        benchmark(true, 200000);
+    }
+}
+
+#endif
+
+static void test_options(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        char* s = argv[i];
+        if (!strcmp(s, "-t") || !strcmp(s, "--time")) {
+            test_time = true;
+        }
+        else {
+            printf("invalid option: %s\n", s);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    test_options(argc, argv);
+
+#ifdef CONFIG_I18N
+    YLocale locale("C.UTF-8");
+    if (YLocale::UTF8() == false) {
+        printf("%s: no UTF-8 locale, skipping tests\n", ApplicationName);
+        return 0;
+    }
+    toUnicode = iconv_open(little() ? "UCS-4LE" : "UCS-4BE", "UTF-8");
+    toLocale = iconv_open("UTF-8//TRANSLIT", little() ? "UCS-4LE" : "UCS-4BE");
+
+    test_valid();
+    YLocale::warnings(false);
+    test_malformed();
+    test_random();
+    YLocale::warnings(true);
+    test_speed();
+
+    iconv_close(toUnicode);
+    iconv_close(toLocale);
+#endif
+
+    return total != 0;
+}
+
+// vim: set sw=4 ts=4 et:
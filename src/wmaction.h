@@ -19,6 +19,7 @@ enum WMAction {
     ICEWM_ACTION_ICEWMBG = 12,
     ICEWM_ACTION_REFRESH = 13,
     ICEWM_ACTION_HIBERNATE = 14,
+    ICEWM_ACTION_LATENCY = 15,
 };
 
 enum RebootShutdown {
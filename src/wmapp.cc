@@ -31,6 +31,7 @@
 #include "theminst.h"
 #include "ycursor.h"
 #include "yxcontext.h"
+#include "ylatency.h"
 #include "ytooltip.h"
 #ifdef CONFIG_XFREETYPE
 #include <ft2build.h>
@@ -2008,6 +2009,9 @@ void YWMApp::handleMsgBox(YMsgBox *msgbox, int operation) {
 }
 
 void YWMApp::handleSMAction(WMAction message) {
+    if (message == ICEWM_ACTION_LATENCY)
+        return YLatency::reportAll();
+
     static const pair<WMAction, EAction> pairs[] = {
         { ICEWM_ACTION_LOGOUT,        actionLogout },
         { ICEWM_ACTION_CANCEL_LOGOUT, actionCancelLogout },
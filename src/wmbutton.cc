@@ -254,6 +254,10 @@ void YFrameButton::configure(const YRect2& r) {
 }
 
 void YFrameButton::repaint() {
+    invalidate(YRect(0, 0, width(), height()));
+}
+
+void YFrameButton::paintInvalid(const YRect*, int, bool) {
     if (fVisible && visible() && width() > 1 && height() > 1) {
         GraphicsBuffer(this).paint();
     }
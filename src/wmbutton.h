@@ -20,6 +20,7 @@ public:
     virtual void handleExpose(const XExposeEvent& expose) {}
     virtual void configure(const YRect2 &r);
     virtual void repaint();
+    virtual void paintInvalid(const YRect* areas, int count, bool clear);
 
     virtual void actionPerformed(YAction action, unsigned int modifiers);
     void setKind(char kind);
@@ -120,31 +120,53 @@ void YFrameClient::getProtocols(bool force) {
     if (!prop.wm_protocols && !force)
         return;
 
-    Atom *wmp = nullptr;
-    int count = 0;
-
     fProtocols &= wpDeleteWindow; // always keep WM_DELETE_WINDOW
 
-    if (XGetWMProtocols(xapp->display(), handle(), &wmp, &count) && wmp) {
+    YProperty wmp(this, _XA_WM_PROTOCOLS, F32, 1000000L, XA_ATOM);
+    if (wmp) {
         prop.wm_protocols = true;
-        for (int i = 0; i < count; i++) {
+        for (Atom atom : wmp) {
             fProtocols |=
-                (wmp[i] == _XA_WM_DELETE_WINDOW) ? wpDeleteWindow :
-                (wmp[i] == _XA_WM_TAKE_FOCUS) ? wpTakeFocus :
-                (wmp[i] == _XA_NET_WM_PING) ? wpPing :
+                (atom == _XA_WM_DELETE_WINDOW) ? wpDeleteWindow :
+                (atom == _XA_WM_TAKE_FOCUS) ? wpTakeFocus :
+                (atom == _XA_NET_WM_PING) ? wpPing :
                 0;
         }
-        XFree(wmp);
     }
 }
 
 void YFrameClient::getSizeHints() {
     if (fSizeHints) {
-        long supplied;
-
-        if (!prop.wm_normal_hints ||
-            !XGetWMNormalHints(xapp->display(), handle(), fSizeHints, &supplied))
-            fSizeHints->flags = 0;
+        // decode WM_NORMAL_HINTS like XGetWMNormalHints
+        fSizeHints->flags = 0;
+        if (prop.wm_normal_hints) {
+            YProperty hint(this, XA_WM_NORMAL_HINTS, F32, 18L,
+                           XA_WM_SIZE_HINTS);
+            if (hint.size() >= 15) {
+                long supplied = USPosition | USSize | PAllHints;
+                fSizeHints->x = int(hint[1]);
+                fSizeHints->y = int(hint[2]);
+                fSizeHints->width = int(hint[3]);
+                fSizeHints->height = int(hint[4]);
+                fSizeHints->min_width = int(hint[5]);
+                fSizeHints->min_height = int(hint[6]);
+                fSizeHints->max_width = int(hint[7]);
+                fSizeHints->max_height = int(hint[8]);
+                fSizeHints->width_inc = int(hint[9]);
+                fSizeHints->height_inc = int(hint[10]);
+                fSizeHints->min_aspect.x = int(hint[11]);
+                fSizeHints->min_aspect.y = int(hint[12]);
+                fSizeHints->max_aspect.x = int(hint[13]);
+                fSizeHints->max_aspect.y = int(hint[14]);
+                if (hint.size() >= 18) {
+                    fSizeHints->base_width = int(hint[15]);
+                    fSizeHints->base_height = int(hint[16]);
+                    fSizeHints->win_gravity = int(hint[17]);
+                    supplied |= PBaseSize | PWinGravity;
+                }
+                fSizeHints->flags = hint[0] & supplied;
+            }
+        }
 
         if (notbit(fSizeHints->flags, PResizeInc) ||
             fSizeHints->width_inc < 1 || fSizeHints->height_inc < 1) {
@@ -210,7 +232,9 @@ void YFrameClient::getTransient() {
         return;
 
     Window newTransientFor = None;
-    if (XGetTransientForHint(xapp->display(), handle(), &newTransientFor)) {
+    YProperty trans(this, XA_WM_TRANSIENT_FOR, F32, 1L, XA_WINDOW);
+    if (trans) {
+        newTransientFor = Window(*trans);
         if (newTransientFor == None)
             newTransientFor = xapp->root();
         if (newTransientFor == handle())    /* bug in fdesign */
@@ -1258,7 +1282,20 @@ void YFrameClient::getWMHints() {
     if (!prop.wm_hints)
         return;
 
-    fHints = XGetWMHints(xapp->display(), handle());
+    // decode WM_HINTS like XGetWMHints
+    YProperty hint(this, XA_WM_HINTS, F32, 9L, XA_WM_HINTS);
+    if (hint.size() >= 8) {
+        fHints = XAllocWMHints();
+        fHints->flags = hint[0];
+        fHints->input = hint[1] ? True : False;
+        fHints->initial_state = int(hint[2]);
+        fHints->icon_pixmap = Pixmap(hint[3]);
+        fHints->icon_window = Window(hint[4]);
+        fHints->icon_x = int(hint[5]);
+        fHints->icon_y = int(hint[6]);
+        fHints->icon_mask = Pixmap(hint[7]);
+        fHints->window_group = hint.size() >= 9 ? Window(hint[8]) : None;
+    }
     if (!fClientLeader && windowGroupHint()) {
         fClientLeader = fHints->window_group;
     }
@@ -1814,8 +1851,8 @@ bool YFrameClient::getNetStartupId(unsigned long &time) {
     if (!prop.net_startup_id)
         return false;
 
-    YTextProperty id(nullptr);
-    if (XGetTextProperty(xapp->display(), handle(), &id, _XA_NET_STARTUP_ID)) {
+    YTextProperty id(handle(), _XA_NET_STARTUP_ID);
+    if (id.value) {
         char* str = strstr((char *)id.value, "_TIME");
         if (str) {
             time = atol(str + 5) & 0xffffffff;
@@ -1925,7 +1962,7 @@ void YFrameClient::getPropertiesList() {
 
     memset(&prop, 0, sizeof(prop));
 
-    p = XListProperties(xapp->display(), handle(), &count);
+    p = YPrefetch::listProperties(handle(), &count);
 
 #define HAS(x)   ((x) = true)
 
@@ -2046,8 +2083,18 @@ char* ClassHint::resource() const {
 
 bool ClassHint::get(Window win) {
     reset();
-    YProperty::fRequest = XA_WM_CLASS;
-    return XGetClassHint(xapp->display(), win, this);
+    YProperty prop(win, XA_WM_CLASS, F8, BUFSIZ, XA_STRING);
+    if (prop) {
+        // the instance and class names follow each other, like Xlib
+        const char* name = prop.string();
+        size_t size = prop.size();
+        size_t len = strnlen(name, size);
+        res_name = strndup(name, len);
+        res_class = len + 1 < size
+                  ? strndup(name + len + 1, size - len - 1)
+                  : strdup("");
+    }
+    return prop;
 }
 
 // vim: set sw=4 ts=4 et:
@@ -2293,25 +2293,7 @@ void YFrameWindow::refresh() {
 
 void YFrameWindow::repaint() {
     if (hasBorders()) {
-        paint(getGraphics(), geometry());
-    }
-}
-
-static Bool checkExpose(Display* display, XEvent* event, XPointer arg) {
-    if (event->type == Expose && event->xexpose.window == *(Window*)arg) {
-        *(Window*)arg = None;
-    }
-    return False;
-}
-
-void YFrameWindow::handleExpose(const XExposeEvent &expose) {
-    if (expose.count == 0) {
-        XEvent check;
-        Window where = expose.window;
-        XCheckIfEvent(xapp->display(), &check, checkExpose, (XPointer) &where);
-        if (where == expose.window) {
-            repaint();
-        }
+        invalidate(YRect(0, 0, width(), height()));
     }
 }
 
@@ -70,7 +70,6 @@ public:
     virtual void handleCrossing(const XCrossingEvent &crossing);
     virtual void handleFocus(const XFocusChangeEvent &focus);
     virtual void handleConfigure(const XConfigureEvent &configure);
-    virtual void handleExpose(const XExposeEvent &expose);
 
     virtual bool handleTimer(YTimer *t);
 
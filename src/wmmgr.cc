@@ -28,6 +28,7 @@
 #include "ystring.h"
 #include "intl.h"
 #include "ywordexp.h"
+#include "ytrace.h"
 
 YContext<YFrameClient> clientContext("clientContext", false);
 
@@ -953,6 +954,7 @@ void YWindowManager::handleClientMessage(const XClientMessageEvent &message) {
         case ICEWM_ACTION_ICEWMBG:
         case ICEWM_ACTION_REFRESH:
         case ICEWM_ACTION_HIBERNATE:
+        case ICEWM_ACTION_LATENCY:
             smActionListener->handleSMAction(action);
             break;
         }
@@ -1193,7 +1195,47 @@ void YWindowManager::setColormapWindow(YFrameWindow *frame) {
     }
 }
 
+// Batch the attribute and property requests for a new client,
+// which otherwise would each wait for a reply from the server.
+class ClientPrefetch : public YPrefetch {
+public:
+    explicit ClientPrefetch(Window window) :
+        YPrefetch(window, atoms(), count)
+    { }
+    ~ClientPrefetch() {
+        if (YTrace::traces("prefetch"))
+            tlog("prefetch: 0x%lx: %d round trips, %d replies prefetched",
+                 window(), roundTrips(), prefetched());
+    }
+
+private:
+    static const int count = 28;
+    static const Atom* atoms() {
+        static const Atom list[count] = {
+            XA_WM_HINTS, XA_WM_NORMAL_HINTS, XA_WM_TRANSIENT_FOR,
+            XA_WM_NAME, XA_WM_ICON_NAME, XA_WM_CLASS,
+            _XA_NET_WM_NAME, _XA_NET_WM_ICON_NAME,
+            _XA_WM_PROTOCOLS, _XA_WM_CLIENT_LEADER,
+            _XA_WM_WINDOW_ROLE, _XA_WINDOW_ROLE,
+            _XA_SM_CLIENT_ID, _XATOM_MWM_HINTS,
+            _XA_KDE_NET_WM_SYSTEM_TRAY_WINDOW_FOR,
+            _XA_NET_WM_STRUT, _XA_NET_WM_STRUT_PARTIAL,
+            _XA_NET_WM_DESKTOP, _XA_NET_WM_PID,
+            _XA_NET_WM_STATE, _XA_NET_WM_WINDOW_TYPE,
+            _XA_NET_STARTUP_ID, _XA_NET_WM_USER_TIME,
+            _XA_NET_WM_USER_TIME_WINDOW,
+            _XA_NET_WM_WINDOW_OPACITY, _XA_WIN_TRAY,
+            _XA_WIN_LAYER, _XA_XEMBED_INFO,
+        };
+        return list;
+    }
+};
+
 void YWindowManager::manageClients() {
+    const timeval started = monotime();
+    const int trips = YPrefetch::totalTrips();
+    int managed = 0;
+
     YWindow sheet(this);
     sheet.setStyle(wsOverrideRedirect);
     sheet.lower();
@@ -1258,12 +1300,26 @@ void YWindowManager::manageClients() {
             fDockApp ? fDockApp->handle() : None,
             sheet.handle()
         };
+        YArray<Window> probe;
         for (unsigned i = 0; i < count; i++) {
-            const Window win = clients[i];
             int k = 0;
-            while (k < igsize && ignore[k] != win)
+            while (k < igsize && ignore[k] != clients[i])
                 ++k;
-            if (k == igsize && findClient(win) == nullptr) {
+            if (k == igsize)
+                probe += clients[i];
+        }
+
+        // query the next batch of windows before managing any of them
+        const int batch = 64;
+        YObjectArray<ClientPrefetch> prefetch;
+        for (int i = 0; i < probe.getCount(); i++) {
+            if (i % batch == 0) {
+                prefetch.clear();
+                for (int j = i; j < probe.getCount() && j < i + batch; ++j)
+                    prefetch += new ClientPrefetch(probe[j]);
+            }
+            const Window win = probe[i];
+            if (findClient(win) == nullptr) {
                 YFrameClient* client = allocateClient(win, false);
                 if (client) {
                     restore* res = tabbing.find(client->handle());
@@ -1282,16 +1338,20 @@ void YWindowManager::manageClients() {
                         res->frame->createTab(client, pos);
                         if (fSwitchWindow)
                             fSwitchWindow->createdClient(res->frame, client);
+                        ++managed;
                     }
                     else if (tabbingClient(client) == false) {
                         manageClient(client);
                         if (client->getFrame() == nullptr) {
                             delete client;
                         }
-                        else if (res) {
-                            res->frame = client->getFrame();
-                            if (res->name && !res->frame->getFrameName())
-                                res->frame->setFrameName(res->name);
+                        else {
+                            ++managed;
+                            if (res) {
+                                res->frame = client->getFrame();
+                                if (res->name && !res->frame->getFrameName())
+                                    res->frame->setFrameName(res->name);
+                            }
                         }
                     }
                 }
@@ -1305,6 +1365,13 @@ void YWindowManager::manageClients() {
     unlockRestack();
     unlockWorkArea();
 
+    if (YTrace::traces("startup")) {
+        tlog("startup: managed %d of %u windows in %.1f ms, "
+             "%d round trips for attributes and properties",
+             managed, count, 1e3 * toDouble(monotime() - started),
+             YPrefetch::totalTrips() - trips);
+    }
+
     YProperty prop(this, _XA_NET_ACTIVE_WINDOW, F32, 1, XA_WINDOW);
     if (prop && prop[0]) {
         YFrameWindow* frame = findFrame(prop[0]);
@@ -1808,7 +1875,7 @@ YFrameClient* YWindowManager::allocateClient(Window win, bool mapClient) {
     YFrameClient* client = nullptr;
     XWindowAttributes attributes;
     int layer = WinLayerInvalid;
-    if (XGetWindowAttributes(xapp->display(), win, &attributes) &&
+    if (YPrefetch::getAttributes(win, &attributes) &&
         (attributes.override_redirect
             ? ignoreOverride(win, attributes, &layer)
             : isManageable(win, mapClient)) &&
@@ -2015,6 +2082,7 @@ void YWindowManager::mapClient(Window win) {
         grabServer();
         lockWorkArea();
 
+        ClientPrefetch prefetch(win);
         if (client == nullptr) {
             client = allocateClient(win, true);
         }
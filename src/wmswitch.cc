@@ -607,7 +607,7 @@ void SwitchWindow::paint(Graphics &g, const YRect &/*r*/) {
         g.drawBorderW(0, 0, width() - 1, height() - 1, true);
 
     if (fGradient != null)
-        g.drawImage(fGradient, b1, b1, width() - b2, height() - b2, b1, b1);
+        g.drawCached(fGradient, b1, b1, width() - b2, height() - b2, b1, b1);
     else
     if (switchbackPixmap != null)
         g.fillPixmap(switchbackPixmap, b1, b1, width() - b3, height() - b3);
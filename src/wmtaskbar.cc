@@ -851,8 +851,8 @@ void TaskBar::paint(Graphics &g, const YRect& r) {
 
     // When TaskBarDoubleHeight=1 this draws the upper half.
     if (fGradient != null) {
-        g.drawImage(fGradient, r.x(), r.y(), r.width(), r.height(),
-                    r.x(), r.y());
+        g.drawCached(fGradient, r.x(), r.y(), r.width(), r.height(),
+                     r.x(), r.y());
     }
     else if (taskbackPixmap != null) {
         g.fillPixmap(taskbackPixmap, r.x(), r.y(), r.width(), r.height(),
@@ -28,6 +28,93 @@ static YColorName titleBarShadowText[2] = {
     &clrInactiveTitleBarShadow, &clrActiveTitleBarShadow
 };
 
+struct TitleLayout {
+    unsigned width, height, depth;
+    bool focused;
+    int onLeft, onRight;
+    int textLeft, textRight;
+
+    bool operator==(const TitleLayout& t) const {
+        return width == t.width && height == t.height && depth == t.depth
+            && focused == t.focused && onLeft == t.onLeft
+            && onRight == t.onRight && textLeft == t.textLeft
+            && textRight == t.textRight;
+    }
+};
+
+// Recently painted title bar backgrounds for the pixmap looks.
+// A background depends on the size, the focus and where the buttons
+// and the title text go, but not on the text itself, so a repaint
+// for focus changes or title updates is mostly a single copy.
+class TitleCache {
+public:
+    TitleCache() : fSerial(0), fHits(0), fMisses(0), fPixels(0) { }
+
+    Pixmap find(const TitleLayout& layout);
+    Pixmap insert(const TitleLayout& layout);
+
+private:
+    enum { MaxCached = 32, MaxPixels = 4 << 20 };
+    struct Entry {
+        TitleLayout layout;
+        Pixmap pixmap;
+        unsigned serial;
+    };
+    void discard(int index);
+
+    YArray<Entry> fEntries;
+    unsigned fSerial;
+    unsigned fHits;
+    unsigned fMisses;
+    unsigned long fPixels;
+};
+
+static TitleCache titleCache;
+
+Pixmap TitleCache::find(const TitleLayout& layout) {
+    for (Entry& e : fEntries) {
+        if (e.layout == layout) {
+            e.serial = ++fSerial;
+            fHits++;
+            return e.pixmap;
+        }
+    }
+    fMisses++;
+    return None;
+}
+
+Pixmap TitleCache::insert(const TitleLayout& layout) {
+    const unsigned long pixels = layout.width * layout.height;
+    while (fEntries.nonempty() && (fEntries.getCount() >= MaxCached ||
+                                   fPixels + pixels > MaxPixels))
+    {
+        int oldest = 0;
+        for (int i = 1; i < fEntries.getCount(); ++i)
+            if (fEntries[i].serial < fEntries[oldest].serial)
+                oldest = i;
+        discard(oldest);
+    }
+    Entry e = {
+        layout,
+        XCreatePixmap(xapp->display(), xapp->root(),
+                      layout.width, layout.height, layout.depth),
+        ++fSerial,
+    };
+    fEntries += e;
+    fPixels += pixels;
+    MSG(("title cache: %u hits, %u misses, %d cached",
+         fHits, fMisses, fEntries.getCount()));
+    return e.pixmap;
+}
+
+void TitleCache::discard(int index) {
+    const TitleLayout& layout(fEntries[index].layout);
+    fPixels -= layout.width * layout.height;
+    Graphics::forget(fEntries[index].pixmap);
+    XFreePixmap(xapp->display(), fEntries[index].pixmap);
+    fEntries.remove(index);
+}
+
 void YFrameTitleBar::initTitleColorsFonts() {
     if (titleFont == null) {
         titleFont = titleFontName;
@@ -437,6 +524,10 @@ void YFrameTitleBar::refresh() {
 }
 
 void YFrameTitleBar::repaint() {
+    invalidate(YRect(0, 0, width(), height()));
+}
+
+void YFrameTitleBar::paintInvalid(const YRect*, int, bool) {
     if (fVisible && width() > 1 && height() > 1 && getFrame()->tabCount()) {
         GraphicsBuffer(this).paint();
     }
@@ -598,15 +689,10 @@ void YFrameTitleBar::paint(Graphics &g, const YRect &/*r*/) {
         bool const pi(foci);
 
         // !!! we really need a fallback mechanism for small windows
-        if (titleL[pi] != null) {
-            g.drawPixmap(titleL[pi], onLeft, 0);
+        if (titleL[pi] != null)
             onLeft += int(titleL[pi]->width());
-        }
-
-        if (titleR[pi] != null) {
+        if (titleR[pi] != null)
             onRight -= int(titleR[pi]->width());
-            g.drawPixmap(titleR[pi], onRight, 0);
-        }
 
         int lLeft(onLeft + (titleP[pi] != null ? (int)titleP[pi]->width() : 0)),
             lRight(onRight - (titleM[pi] != null ? (int)titleM[pi]->width() : 0));
@@ -618,70 +704,17 @@ void YFrameTitleBar::paint(Graphics &g, const YRect &/*r*/) {
         stringOffset = lLeft + (lRight - lLeft - tlen - llen - rlen)
                      * titleBarJustify / 100;
 
-        lLeft = stringOffset;
-        lRight = stringOffset + tlen + llen + rlen;
-
-        if (lLeft < lRight) {
-            if (rgbTitleT[pi] != null) {
-                int const gx(titleBarJoinLeft ? lLeft - onLeft : 0);
-                int const gw((titleBarJoinRight ? onRight : lRight) -
-                             (titleBarJoinLeft ? onLeft : lLeft));
-                g.drawGradient(rgbTitleT[pi], lLeft, 0,
-                               lRight - lLeft, height(), gx, 0, gw, height());
-            }
-            else if (titleT[pi] != null)
-                g.repHorz(titleT[pi], lLeft, 0, lRight - lLeft);
-            else
-                g.fillRect(lLeft, 0, lRight - lLeft, height());
-        }
-
-        if (titleP[pi] != null) {
-            lLeft -= int(titleP[pi]->width());
-            g.drawPixmap(titleP[pi], lLeft, 0);
-        }
-        if (titleM[pi] != null) {
-            g.drawPixmap(titleM[pi], lRight, 0);
-            lRight += int(titleM[pi]->width());
-        }
-
-        if (onLeft < lLeft) {
-            if (rgbTitleS[pi] != null) {
-                int const gw((titleBarJoinLeft ? titleBarJoinRight ?
-                              onRight : lRight : lLeft) - onLeft);
-                g.drawGradient(rgbTitleS[pi], onLeft, 0,
-                               lLeft - onLeft, height(), 0, 0, gw, height());
-            }
-            else if (titleS[pi] != null && titleS[pi]->pixmap())
-                g.repHorz(titleS[pi], onLeft, 0, lLeft - onLeft);
-            else
-                g.fillRect(onLeft, 0, lLeft - onLeft, height());
-        }
-        if (lRight < onRight) {
-            if (rgbTitleB[pi] != null) {
-                int const gx(titleBarJoinRight ? titleBarJoinLeft ?
-                             lRight - onLeft: lRight - lLeft : 0);
-                int const gw(titleBarJoinRight ? titleBarJoinLeft ?
-                             onRight - onLeft : onRight - lLeft : onRight - lRight);
-
-                g.drawGradient(rgbTitleB[pi], lRight, 0,
-                               onRight - lRight, height(), gx, 0, gw, height());
-            }
-            else if (titleB[pi] != null && titleB[pi]->pixmap())
-                g.repHorz(titleB[pi], lRight, 0, onRight - lRight);
-            else
-                g.fillRect(lRight, 0, onRight - lRight, height());
-        }
-
-        if (titleJ[pi] != null)
-            g.drawPixmap(titleJ[pi], 0, 0);
-        if (titleQ[pi] != null)
-            g.drawPixmap(titleQ[pi], int(width() - titleQ[pi]->width()), 0);
-
-        if (rgbTitleB[pi] != null || rgbTitleS[pi] != null ||
-            rgbTitleT[pi] != null)
-        {
-            g.maxOpacity();
-        }
+        TitleLayout layout = {
+            width(), height(), g.rdepth(), pi, onLeft, onRight,
+            stringOffset, stringOffset + tlen + llen + rlen,
+        };
+        Pixmap background = titleCache.find(layout);
+        if (background == None) {
+            background = titleCache.insert(layout);
+            Graphics back(background, width(), height(), g.rdepth());
+            paintBackground(back, layout);
+        }
+        g.copyDrawable(background, 0, 0, width(), height(), 0, 0);
         break;
     }
     }
@@ -731,6 +764,82 @@ void YFrameTitleBar::paint(Graphics &g, const YRect &/*r*/) {
     }
 }
 
+void YFrameTitleBar::paintBackground(Graphics& g, const TitleLayout& t) {
+    bool const pi(t.focused);
+    int onLeft(t.onLeft), onRight(t.onRight);
+    int lLeft(t.textLeft), lRight(t.textRight);
+
+    g.setColor(titleBarBackground[pi]);
+    g.fillRect(0, 0, width(), height());
+
+    if (titleL[pi] != null)
+        g.drawPixmap(titleL[pi], onLeft - int(titleL[pi]->width()), 0);
+    if (titleR[pi] != null)
+        g.drawPixmap(titleR[pi], onRight, 0);
+
+    if (lLeft < lRight) {
+        if (rgbTitleT[pi] != null) {
+            int const gx(titleBarJoinLeft ? lLeft - onLeft : 0);
+            int const gw((titleBarJoinRight ? onRight : lRight) -
+                         (titleBarJoinLeft ? onLeft : lLeft));
+            g.drawGradient(rgbTitleT[pi], lLeft, 0,
+                           lRight - lLeft, height(), gx, 0, gw, height());
+        }
+        else if (titleT[pi] != null)
+            g.repHorz(titleT[pi], lLeft, 0, lRight - lLeft);
+        else
+            g.fillRect(lLeft, 0, lRight - lLeft, height());
+    }
+
+    if (titleP[pi] != null) {
+        lLeft -= int(titleP[pi]->width());
+        g.drawPixmap(titleP[pi], lLeft, 0);
+    }
+    if (titleM[pi] != null) {
+        g.drawPixmap(titleM[pi], lRight, 0);
+        lRight += int(titleM[pi]->width());
+    }
+
+    if (onLeft < lLeft) {
+        if (rgbTitleS[pi] != null) {
+            int const gw((titleBarJoinLeft ? titleBarJoinRight ?
+                          onRight : lRight : lLeft) - onLeft);
+            g.drawGradient(rgbTitleS[pi], onLeft, 0,
+                           lLeft - onLeft, height(), 0, 0, gw, height());
+        }
+        else if (titleS[pi] != null && titleS[pi]->pixmap())
+            g.repHorz(titleS[pi], onLeft, 0, lLeft - onLeft);
+        else
+            g.fillRect(onLeft, 0, lLeft - onLeft, height());
+    }
+    if (lRight < onRight) {
+        if (rgbTitleB[pi] != null) {
+            int const gx(titleBarJoinRight ? titleBarJoinLeft ?
+                         lRight - onLeft: lRight - lLeft : 0);
+            int const gw(titleBarJoinRight ? titleBarJoinLeft ?
+                         onRight - onLeft : onRight - lLeft : onRight - lRight);
+
+            g.drawGradient(rgbTitleB[pi], lRight, 0,
+                           onRight - lRight, height(), gx, 0, gw, height());
+        }
+        else if (titleB[pi] != null && titleB[pi]->pixmap())
+            g.repHorz(titleB[pi], lRight, 0, onRight - lRight);
+        else
+            g.fillRect(lRight, 0, onRight - lRight, height());
+    }
+
+    if (titleJ[pi] != null)
+        g.drawPixmap(titleJ[pi], 0, 0);
+    if (titleQ[pi] != null)
+        g.drawPixmap(titleQ[pi], int(width() - titleQ[pi]->width()), 0);
+
+    if (rgbTitleB[pi] != null || rgbTitleS[pi] != null ||
+        rgbTitleT[pi] != null)
+    {
+        g.maxOpacity();
+    }
+}
+
 void YFrameTitleBar::renderShape(Graphics& g) {
 #ifdef CONFIG_SHAPE
     if (LOOK(lookPixmap | lookMetal | lookGtk | lookFlat))
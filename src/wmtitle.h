@@ -4,6 +4,7 @@
 class YFrameButton;
 class YFrameWindow;
 class YFrameClient;
+struct TitleLayout;
 
 class YFrameTitleBar: public YWindow, private YTimerListener {
 public:
@@ -25,6 +26,7 @@ public:
     virtual bool handleTimer(YTimer* timer);
     virtual void configure(const YRect2& r);
     virtual void repaint();
+    virtual void paintInvalid(const YRect* areas, int count, bool clear);
 
     YFrameWindow* getFrame() const { return fFrame; }
     YFrameClient* getClient() const { return fFrame->client(); }
@@ -53,6 +55,7 @@ public:
 
 private:
     static void initTitleColorsFonts();
+    void paintBackground(Graphics& g, const TitleLayout& layout);
 
     unsigned decors() const { return getFrame()->frameDecors(); }
     bool focused() const { return getFrame()->focused(); }
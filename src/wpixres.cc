@@ -624,6 +624,7 @@ void WPixRes::initPixmaps(IResourceLocator* locator) {
 }
 
 void WPixRes::freePixmaps() {
+    Graphics::clearImages();
     freePixmapResources();
     freePixmapOffsets();
 }
@@ -8,6 +8,8 @@
 #include "ypoll.h"
 #include "ytimer.h"
 #include "yprefs.h"
+#include "ylatency.h"
+#include "ywork.h"
 #include "sysdep.h"
 #include "intl.h"
 
@@ -16,10 +18,17 @@
 #ifdef USE_SIGNALFD
 #include <sys/signalfd.h>
 #endif
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+#endif
 #include "ywordexp.h"
+#include <typeinfo>
 
 IMainLoop *mainLoop;
 int DelayFuzziness = 10;
+int SamplingTick = 250;
+static YLatency timerLatency("timer", true);
+static YLatency pollLatency("poll", true);
 static int signalPipe[2];
 static sigset_t oldSignalMask;
 static sigset_t signalMask;
@@ -64,10 +73,29 @@ void alrm_handler(int /*sig*/) {
 }
 #endif
 
+#ifdef USE_EPOLL
+// The events from one epoll_wait which are still being dispatched.
+// Nested main loops stack their batches, so that unregisterPoll
+// can invalidate a pending event for a poll which is going away.
+struct YApplication::PollBatch {
+    epoll_event events[32];
+    int count;
+    PollBatch* outer;
+};
+#endif
+
 YApplication::YApplication(int * /*argc*/, char *** /*argv*/) :
+#ifdef USE_EPOLL
+    fEpollFd(epoll_create1(EPOLL_CLOEXEC)),
+    fPollBatch(nullptr),
+#endif
     sfd(this),
+    fWorkers(nullptr),
     fLoopLevel(0),
     fExitCode(0),
+    fWakeups(0),
+    fTimerRuns(0),
+    fWakeupsSince(monotime()),
     fExitLoop(false),
     fExitApp(false)
 {
@@ -76,83 +104,107 @@ YApplication::YApplication(int * /*argc*/, char *** /*argv*/) :
     setvbuf(stdout, nullptr, _IOLBF, BUFSIZ);
     setvbuf(stderr, nullptr, _IOLBF, BUFSIZ);
 
+#ifdef USE_EPOLL
+    if (fEpollFd == -1)
+        die(2, "Failed to create epoll instance (errno=%d).", errno);
+#endif
     initSignals();
 }
 
 YApplication::~YApplication() {
+    delete fWorkers;
     sfd.unregisterPoll();
+#ifdef USE_EPOLL
+    close(fEpollFd);
+#endif
     if (::mainLoop == this)
         ::mainLoop = nullptr;
 }
 
+void YTimerHeap::insert(YTimer* timer) {
+    int index = timer->fHeapIndex[fOrder];
+    if (index < 0) {
+        index = fHeap.getCount();
+        fHeap.append(timer);
+        timer->fHeapIndex[fOrder] = index;
+        siftUp(index);
+    } else {
+        siftUp(index);
+        siftDown(timer->fHeapIndex[fOrder]);
+    }
+}
+
+void YTimerHeap::remove(YTimer* timer) {
+    int index = timer->fHeapIndex[fOrder];
+    if (index >= 0) {
+        timer->fHeapIndex[fOrder] = -1;
+        YTimer* last = fHeap.last();
+        fHeap.pop();
+        if (index < fHeap.getCount()) {
+            place(index, last);
+            siftUp(index);
+            siftDown(last->fHeapIndex[fOrder]);
+        }
+    }
+}
+
+void YTimerHeap::siftUp(int index) {
+    YTimer* timer = fHeap[index];
+    const timeval tkey(key(timer));
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if ( !(tkey < key(fHeap[parent])))
+            break;
+        place(index, fHeap[parent]);
+        index = parent;
+    }
+    place(index, timer);
+}
+
+void YTimerHeap::siftDown(int index) {
+    const int count = fHeap.getCount();
+    YTimer* timer = fHeap[index];
+    const timeval tkey(key(timer));
+    for (int child; (child = 2 * index + 1) < count; index = child) {
+        if (child + 1 < count && key(fHeap[child + 1]) < key(fHeap[child]))
+            child += 1;
+        if ( !(key(fHeap[child]) < tkey))
+            break;
+        place(index, fHeap[child]);
+    }
+    place(index, timer);
+}
+
 void YApplication::registerTimer(YTimer *t) {
-    if (find(timers, t) < 0)
-        timers.append(t);
+    timers.insert(t);
 }
 
 void YApplication::unregisterTimer(YTimer *t) {
-    int k = find(timers, t);
-    if (k >= 0)
-        timers.remove(k);
+    timers.remove(t);
 }
 
 bool YApplication::nextTimeout(timeval *timeout) {
-    bool fFirst = true;
-    YArrayIterator<YTimer*> t = timers.iterator();
-    while (++t) {
-        if (t->isRunning() && (fFirst || t->timeout() < *timeout)) {
-            *timeout = t->timeout();
-            fFirst = false;
-        }
+    if (timers.nonempty()) {
+        *timeout = timers.earliest()->timeout_min();
+        return true;
     }
-    return fFirst == false;
+    return false;
 }
 
 bool YApplication::nextTimeoutWithFuzziness(timeval *timeout) {
-    bool fixedExists = false;
-    timeval timeout_fixed = {0, 0L};
-
-    bool fuzzyExists = false;
-    timeval timeout_fuzzy = {0, 0L};
-    timeval timeout_max = {0, 0L};
-
-    for (YArrayIterator<YTimer*> iter = timers.iterator(); ++iter; ) {
-        if (iter->isRunning()) {
-            if (iter->isFixed()) {
-                // Update if no fixed timer yet or current
-                // is earlier than previously registered one.
-                if (false == fixedExists || iter->timeout() < timeout_fixed) {
-                    timeout_fixed = iter->timeout();
-                    fixedExists = true;
-                }
-            }
-            else if (false == fuzzyExists) {
-                // encountered first fuzzy timer, register everything
-                timeout_fuzzy = iter->timeout();
-                timeout_max = iter->timeout_max();
-                fuzzyExists = true;
-            }
-            else if (iter->timeout() < timeout_fuzzy) {
-                // this fuzzy timer is earlier than previous one
-                timeout_fuzzy = iter->timeout();
-                if (iter->timeout_max() < timeout_max)
-                    timeout_max = iter->timeout_max();
-            }
-        }
+    // Sleep until the first timer which can no longer be postponed.
+    // Then all timers within their fuzziness range fire together.
+    // For fixed timers the latest timeout is the exact timeout.
+    if (timers.nonempty()) {
+        *timeout = timers.latest()->timeout_max();
+        return true;
     }
-
-    if (fixedExists && fuzzyExists)
-        *timeout = min(timeout_max, timeout_fixed);
-    else if (fixedExists)
-        *timeout = timeout_fixed;
-    else if (fuzzyExists)
-        *timeout = timeout_max;
-    return fixedExists | fuzzyExists;
+    return false;
 }
 
 bool YApplication::getTimeout(timeval *timeout) {
     bool found = false;
-    if (0 < timers.getCount()) {
+    if (timers.nonempty()) {
         timeval tval = {0, 0L};
         if (inrange(DelayFuzziness, 1, 100))
             found = nextTimeoutWithFuzziness(&tval);
@@ -166,30 +218,103 @@ bool YApplication::getTimeout(timeval *timeout) {
 
 void YApplication::handleTimeouts() {
     timeval now = monotime();
-    YTimer *timeout = nullptr;
-    YArrayIterator<YTimer*> iter = timers.reverseIterator();
-    // we must be careful since the callback may modify the array.
-    while (iter.hasNext()) {
-        if (++iter &&
-            *iter != timeout &&
-            iter->isRunning() &&
-            iter->timeout_min() < now)
-        {
-            timeout = *iter;
-            YTimerListener *listener = timeout->getTimerListener();
-            timeout->stopTimer();
-            if (listener && listener->handleTimer(timeout))
+    // A callback may modify the queue and may even run its timer
+    // again immediately.  Run each timer at most once per pass:
+    // stop at a timer which was enlisted during this pass.
+    timers.nextPass();
+    while (timers.nonempty() && timers.earliest()->timeout_min() < now &&
+           timers.thisPass(timers.earliest()) == false) {
+        YTimer *timeout = timers.earliest();
+        YTimerListener *listener = timeout->getTimerListener();
+        timeout->stopTimer();
+        if (listener) {
+            const char* name = typeid(*listener).name();
+            timeval start = monotime();
+            if (listener->handleTimer(timeout))
                 timeout->startTimer();
+            timerLatency.record(name, start);
+            fTimerRuns++;
+        }
+    }
+}
+
+void YApplication::countWakeup(const timeval& now) {
+    fWakeups++;
+    timeval elapsed = now - fWakeupsSince;
+    if (elapsed.tv_sec >= 60) {
+        if (YTrace::traces("wakeups")) {
+            double minutes = toDouble(elapsed) / 60.0;
+            tlog("wakeups: %.1f per minute, %.1f timers per minute",
+                 fWakeups / minutes, fTimerRuns / minutes);
         }
+        fWakeups = fTimerRuns = 0;
+        fWakeupsSince = now;
     }
 }
 
 void YApplication::decreaseTimeouts(timeval diff) {
-    YArrayIterator<YTimer*> iter = timers.reverseIterator();
-    while (++iter)
-        iter->decreaseTimeout(diff);
+    // a uniform shift preserves the order of both heaps
+    for (int i = timers.getCount(); 0 <= --i; )
+        timers[i]->decreaseTimeout(diff);
 }
 
+#ifdef USE_EPOLL
+
+void YApplication::registerPoll(YPollBase *t) {
+    PRECONDITION(t->fd() >= 0);
+    epoll_event ev = {};
+    if (t->forRead())
+        ev.events |= EPOLLIN;
+    if (t->forWrite())
+        ev.events |= EPOLLOUT;
+    ev.data.ptr = t;
+    if (ev.events == 0) {
+        // hangups are always reported, which nobody would consume
+        epoll_ctl(fEpollFd, EPOLL_CTL_DEL, t->fd(), nullptr);
+    }
+    else if (epoll_ctl(fEpollFd, EPOLL_CTL_ADD, t->fd(), &ev) == -1) {
+        if (errno != EEXIST ||
+            epoll_ctl(fEpollFd, EPOLL_CTL_MOD, t->fd(), &ev) == -1)
+            fail("epoll_ctl %d", t->fd());
+    }
+}
+
+void YApplication::unregisterPoll(YPollBase *t) {
+    // a closed file is already gone from the interest set
+    if (t->fd() >= 0)
+        epoll_ctl(fEpollFd, EPOLL_CTL_DEL, t->fd(), nullptr);
+    for (PollBatch* batch = fPollBatch; batch; batch = batch->outer) {
+        for (int i = 0; i < batch->count; ++i) {
+            if (batch->events[i].data.ptr == t)
+                batch->events[i].data.ptr = nullptr;
+        }
+    }
+}
+
+void YApplication::dispatchPolls(PollBatch& batch) {
+    batch.outer = fPollBatch;
+    fPollBatch = &batch;
+    for (int i = 0; i < batch.count; ++i) {
+        const unsigned events = batch.events[i].events;
+        YPollBase* poll = static_cast<YPollBase*>(batch.events[i].data.ptr);
+        if (poll == nullptr)
+            continue;
+        const char* name = typeid(*poll).name();
+        timeval start = monotime();
+        if ((events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && poll->forRead()) {
+            poll->notifyRead();
+            poll = static_cast<YPollBase*>(batch.events[i].data.ptr);
+        }
+        if (poll && (events & (EPOLLOUT | EPOLLERR)) && poll->forWrite()) {
+            poll->notifyWrite();
+        }
+        pollLatency.record(name, start);
+    }
+    fPollBatch = batch.outer;
+}
+
+#else
+
 void YApplication::registerPoll(YPollBase *t) {
     PRECONDITION(t->fd() >= 0);
     if (find(polls, t) < 0)
@@ -200,6 +325,8 @@ void YApplication::unregisterPoll(YPollBase *t) {
     findRemove(polls, t);
 }
 
+#endif
+
 YPollBase::~YPollBase() {
     unregisterPoll();
 }
@@ -212,11 +339,14 @@ void YPollBase::unregisterPoll() {
 }
 
 void YPollBase::registerPoll(int fd) {
+    if (fRegistered && fd != fFd)
+        unregisterPoll();
     fFd = fd;
     if (fFd < 0) {
         unregisterPoll();
     }
-    else if (fRegistered == false) {
+    else {
+        // also when registered, to update the read/write interest
         mainLoop->registerPoll(this);
         fRegistered = true;
     }
@@ -240,6 +370,7 @@ int YApplication::mainLoop() {
 
     for (fExitLoop = fExitApp; (fExitApp | fExitLoop) == false; ) {
         bool didIdle = handleIdle();
+#ifndef USE_EPOLL
         int nfds = 0;
         fd_set read_fds;
         FD_ZERO(&read_fds);
@@ -258,22 +389,33 @@ int YApplication::mainLoop() {
             if (nfds <= fd)
                 nfds = fd + 1;
         }
+#endif
 
         timeval timeout = {0, 0L};
         timeval *tp = &timeout;
         if (!didIdle && getTimeout(tp) == false)
             tp = nullptr;
+        // select may modify the timeout, so decide this before
+        const bool sleeps = (tp == nullptr || tp->tv_sec || tp->tv_usec);
 
 #ifndef USE_SIGNALFD
         sigprocmask(SIG_UNBLOCK, &signalMask, nullptr);
 #endif
 
         int rc;
+#ifdef USE_EPOLL
+        PollBatch batch;
+        int msec = tp ? int(tp->tv_sec * 1000 + (tp->tv_usec + 999) / 1000)
+                      : -1;
+        rc = batch.count = epoll_wait(fEpollFd, batch.events,
+                                      int ACOUNT(batch.events), msec);
+#else
         rc = select(nfds,
                     SELECT_TYPE_ARG234 &read_fds,
                     SELECT_TYPE_ARG234 &write_fds,
                     nullptr,
                     tp);
+#endif
 
 #ifndef USE_SIGNALFD
         sigprocmask(SIG_BLOCK, &signalMask, nullptr);
@@ -291,6 +433,9 @@ int YApplication::mainLoop() {
             }
             prevtime += diff;
         }
+        // count how often the process slept and was woken
+        if (sleeps)
+            countWakeup(prevtime);
 
         if (rc == 0) {
             handleTimeouts();
@@ -298,16 +443,29 @@ int YApplication::mainLoop() {
             if (errno != EINTR)
                 fail(_("%s: select failed"), __func__);
         } else {
+#ifdef USE_EPOLL
+            dispatchPolls(batch);
+#else
             for (YPollIterType iPoll = polls.reverseIterator(); ++iPoll; ) {
+                const int fd = iPoll->fd();
+                if (fd < 0 || (FD_ISSET(fd, &read_fds) == 0 &&
+                               FD_ISSET(fd, &write_fds) == 0))
+                    continue;
+                const char* name = typeid(**iPoll).name();
+                timeval start = monotime();
                 if (iPoll->fd() >= 0 && FD_ISSET(iPoll->fd(), &read_fds)) {
                     iPoll->notifyRead();
-                    if (iPoll.isValid() == false)
+                    if (iPoll.isValid() == false) {
+                        pollLatency.record(name, start);
                         continue;
+                    }
                 }
                 if (iPoll->fd() >= 0 && FD_ISSET(iPoll->fd(), &write_fds)) {
                     iPoll->notifyWrite();
                 }
+                pollLatency.record(name, start);
             }
+#endif
         }
     }
     fLoopLevel--;
@@ -497,6 +655,16 @@ void YApplication::unregisterWait(YPidWaiter* waiter) {
     }
 }
 
+void YApplication::submitJob(YJob* job) {
+    if (fWorkers == nullptr)
+        fWorkers = new YWorkerPool();
+    fWorkers->submit(job);
+}
+
+bool YApplication::cancelJob(YJob* job) {
+    return fWorkers && fWorkers->cancel(job);
+}
+
 YPidWaiter::~YPidWaiter() {
     mainLoop->unregisterWait(this);
 }
@@ -4,9 +4,81 @@
 #include "upath.h"
 #include "yarray.h"
 #include "ypoll.h"
+#include "ytimer.h"
 #include "ytrace.h"
 
-class YTimer;
+#ifdef HAVE_SYS_EPOLL_H
+#define USE_EPOLL
+#endif
+
+// A binary min-heap of timers, ordered by either
+// the earliest or the latest time at which they may fire.
+class YTimerHeap {
+public:
+    enum Order { EarliestFirst, LatestFirst };
+    explicit YTimerHeap(Order order) : fOrder(order) { }
+
+    void insert(YTimer* timer);     // also reorders a queued timer
+    void remove(YTimer* timer);
+
+    YTimer* top() const { return fHeap[0]; }
+    YTimer* operator[](int index) const { return fHeap[index]; }
+    int getCount() const { return fHeap.getCount(); }
+    bool isEmpty() const { return fHeap.isEmpty(); }
+    bool nonempty() const { return fHeap.nonempty(); }
+
+private:
+    const Order fOrder;
+    YArray<YTimer*> fHeap;
+
+    timeval key(const YTimer* t) const {
+        return fOrder == EarliestFirst ? t->timeout_min() : t->timeout_max();
+    }
+    void place(int index, YTimer* timer) {
+        fHeap[index] = timer;
+        timer->fHeapIndex[fOrder] = index;
+    }
+    void siftUp(int index);
+    void siftDown(int index);
+};
+
+// The running timers of the main loop, in two heaps:
+// by when they may fire, and by when they must fire.
+class YTimerQueue {
+public:
+    YTimerQueue() : fEarliest(YTimerHeap::EarliestFirst),
+                    fLatest(YTimerHeap::LatestFirst), fPass(0) { }
+
+    void insert(YTimer* timer) {
+        timer->fPass = fPass;
+        fEarliest.insert(timer);
+        fLatest.insert(timer);
+    }
+    void remove(YTimer* timer) {
+        fEarliest.remove(timer);
+        fLatest.remove(timer);
+    }
+
+    // the timer which may expire first
+    YTimer* earliest() const { return fEarliest.top(); }
+    // the timer which must expire first
+    YTimer* latest() const { return fLatest.top(); }
+
+    // begin a pass over the expired timers
+    void nextPass() { ++fPass; }
+    // whether the timer was (re)enlisted during the current pass
+    bool thisPass(const YTimer* timer) const { return timer->fPass == fPass; }
+
+    YTimer* operator[](int index) const { return fEarliest[index]; }
+    int getCount() const { return fEarliest.getCount(); }
+    bool isEmpty() const { return fEarliest.isEmpty(); }
+    bool nonempty() const { return fEarliest.nonempty(); }
+
+private:
+    YTimerHeap fEarliest;
+    YTimerHeap fLatest;
+    unsigned fPass;
+};
 
 class YSignalPoll: public YPoll<class YApplication> {
 public:
@@ -34,6 +106,8 @@ public:
     virtual void unregisterPoll(YPollBase *t) = 0;
     virtual void unregisterWait(YPidWaiter *w) = 0;
     virtual void registerWait(int pid, YPidWaiter* waiter) = 0;
+    virtual void submitJob(class YJob* job) = 0;
+    virtual bool cancelJob(class YJob* job) = 0;
 };
 
 class IResourceLocator {
@@ -63,6 +137,11 @@ public:
     virtual void registerWait(int pid, YPidWaiter* waiter);
     virtual void unregisterWait(YPidWaiter* waiter);
 
+    // run a blocking job on a worker thread
+    virtual void submitJob(class YJob* job);
+    // prevent completion of a job and delete it
+    virtual bool cancelJob(class YJob* job);
+
     virtual void subdirs(const char* sd, bool to, class MStringArray& ms);
     virtual upath findConfigFile(upath relativePath);
     static upath locateConfigFile(upath relativePath);
@@ -73,9 +152,17 @@ public:
     static upath getHomeDir();
 
 private:
-    YArray<YTimer*> timers;
+    YTimerQueue timers;
+#ifdef USE_EPOLL
+    // polls live in a persistent epoll interest set
+    int fEpollFd;
+    struct PollBatch;
+    PollBatch* fPollBatch;
+    void dispatchPolls(PollBatch& batch);
+#else
     YArray<YPollBase*> polls;
     typedef YArray<YPollBase*>::IterType YPollIterType;
+#endif
 
     struct WaitHandler {
         int pid;
@@ -87,13 +174,19 @@ private:
     YSignalPoll sfd;
     friend class YSignalPoll;
 
+    class YWorkerPool* fWorkers;
+
     int fLoopLevel;
     int fExitCode;
+    int fWakeups;
+    int fTimerRuns;
+    timeval fWakeupsSince;
     bool fExitLoop;
     bool fExitApp;
 
     bool getTimeout(struct timeval *timeout);
     void handleTimeouts();
+    void countWakeup(const timeval& now);
     void decreaseTimeouts(struct timeval difftime);
 
     void handleSignalPipe();
@@ -583,12 +583,19 @@ private:
     BaseType* base;
     DataType* data;
     int rows, cols;
+    int head;
+
+    // rows are a ring which starts at head
+    BaseType row(int index) const {
+        index += head;
+        return base[index < rows ? index : index - rows];
+    }
 
 public:
     YMulti(int rows, int cols) :
         base(new BaseType[rows]),
         data(new DataType[rows * cols]),
-        rows(rows), cols(cols)
+        rows(rows), cols(cols), head(0)
     {
         for (int i = 0; i < rows; ++i)
             base[i] = data + i * cols;
@@ -599,7 +606,12 @@ public:
     }
 
     BaseType operator[](int index) const {
-        return base[index];
+        return row(index);
+    }
+
+    // the first row becomes the last, and all others move up by one
+    void rotate() {
+        head = (head + 1 < rows) ? head + 1 : 0;
     }
 
     void clear() const {
@@ -607,25 +619,26 @@ public:
     }
 
     void clear(int index) const {
-        memset(base[index], 0, sizeof(DataType) * cols);
+        memset(row(index), 0, sizeof(DataType) * cols);
     }
 
     int compare(int left, int right) const {
+        BaseType l(row(left)), r(row(right));
         int i = -1;
-        while (++i < cols && base[left][i] == base[right][i]);
-        return i < cols ? base[left][i] < base[right][i] ? -1 : +1 : 0;
+        while (++i < cols && l[i] == r[i]);
+        return i < cols ? l[i] < r[i] ? -1 : +1 : 0;
     }
 
     void copyTo(int from, int dest) const {
-        memcpy(base[dest], base[from], sizeof(DataType) * cols);
+        memcpy(row(dest), row(from), sizeof(DataType) * cols);
     }
 
     void copyFrom(int dest, BaseType from) const {
-        memcpy(base[dest], from, sizeof(DataType) * cols);
+        memcpy(row(dest), from, sizeof(DataType) * cols);
     }
 
-    DataType sum(int row) const {
-        DataType *ptr(base[row]), *end(ptr + cols), total(*ptr);
+    DataType sum(int index) const {
+        DataType *ptr(row(index)), *end(ptr + cols), total(*ptr);
         while (++ptr < end) total += *ptr;
         return total;
     }
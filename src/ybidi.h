@@ -16,18 +16,20 @@
 #endif
 #endif
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 class YBidi {
 public:
     YBidi(wchar_t* string, size_t length)
         : str(string)
         , len(length)
-#ifdef CONFIG_FRIBIDI
-        , big(new wchar_t[length + 1])
-#endif
         , rtl(false)
     {
 #ifdef CONFIG_FRIBIDI
-        if (big) {
+        if (bidirectional(string, length)) {
+            big = new wchar_t[length + 1];
             FriBidiCharType pbase_dir = FRIBIDI_PAR_ON;
             switch (int(true)) {
                 case sizeof(wchar_t) == sizeof(unsigned):
@@ -47,6 +49,47 @@ public:
     wchar_t* string() const { return str; }
     size_t length() const { return len; }
     bool isRTL() const { return rtl; }
+
+    // Whether a character is of a right-to-left script
+    // or controls the direction of text explicitly.
+    static bool bidirectional(unsigned c) {
+        return (0x0590 <= c && c <= 0x08FF) ||
+               (0x200E <= c && c <= 0x200F) ||
+               (0x202A <= c && c <= 0x202E) ||
+               (0x2066 <= c && c <= 0x2069) ||
+               (0xFB1D <= c && c <= 0xFDFF) ||
+               (0xFE70 <= c && c <= 0xFEFF) ||
+               (0x10800 <= c && c <= 0x10FFF) ||
+               (0x1E800 <= c && c <= 0x1EFFF);
+    }
+
+    // Whether the text may be reordered, when it is not all left-to-right.
+    // Eight characters before U+0590 are passed over at a time.
+    static bool bidirectional(const wchar_t* string, size_t length) {
+        size_t i = 0;
+#ifdef __SSE2__
+        if (sizeof(wchar_t) == 4) {
+            const __m128i limit = _mm_set1_epi32(0x0590);
+            for (; i + 8 <= length; i += 8) {
+                const __m128i* p = (const __m128i *) (string + i);
+                __m128i a = _mm_cmplt_epi32(_mm_loadu_si128(p), limit);
+                __m128i b = _mm_cmplt_epi32(_mm_loadu_si128(p + 1), limit);
+                if (_mm_movemask_epi8(_mm_and_si128(a, b)) != 0xFFFF) {
+                    for (size_t k = i; k < i + 8; ++k) {
+                        if (bidirectional(unsigned(string[k])))
+                            return true;
+                    }
+                }
+            }
+        }
+#endif
+        for (; i < length; ++i) {
+            if (bidirectional(unsigned(string[i])))
+                return true;
+        }
+        return false;
+    }
+
 private:
     wchar_t* str;
     size_t len;
@@ -0,0 +1,75 @@
+/*
+ *  IceWM - Unicode coverage of fonts
+ *
+ *  Release under terms of the GNU Library General Public License
+ */
+
+#include "config.h"
+
+#ifdef CONFIG_XFREETYPE
+
+#include "ycoverage.h"
+#include <fontconfig/fontconfig.h>
+
+// blocks which are shared by all fonts
+static const uint32_t noGlyphs[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+static const uint32_t allGlyphs[8] = {
+    ~0U, ~0U, ~0U, ~0U, ~0U, ~0U, ~0U, ~0U,
+};
+
+YCoverage::YCoverage(const FcCharSet* charset) :
+    fCharset(charset)
+{
+    for (auto& plane : fPlanes)
+        plane = nullptr;
+}
+
+YCoverage::~YCoverage() {
+    for (auto plane : fPlanes) {
+        if (plane) {
+            for (int i = 0; i < Blocks; ++i) {
+                if (plane[i] != noGlyphs && plane[i] != allGlyphs)
+                    delete[] plane[i];
+            }
+            delete[] plane;
+        }
+    }
+}
+
+const uint32_t* YCoverage::fill(unsigned block) const {
+    const uint32_t** &plane = fPlanes[block >> 8];
+    if (plane == nullptr) {
+        plane = new const uint32_t*[Blocks];
+        for (int i = 0; i < Blocks; ++i)
+            plane[i] = nullptr;
+    }
+
+    uint32_t bits[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+    if (fCharset) {
+        const FcChar32 base = block << 8;
+        for (int i = 0; i < 256; ++i) {
+            if (FcCharSetHasChar(fCharset, base + i))
+                bits[i >> 5] |= 1U << (i & 31);
+        }
+    }
+
+    bool none = true, all = true;
+    for (uint32_t word : bits) {
+        none &= (word == 0);
+        all &= (word == ~0U);
+    }
+
+    const uint32_t* result = none ? noGlyphs : all ? allGlyphs : nullptr;
+    if (result == nullptr) {
+        uint32_t* copy = new uint32_t[8];
+        for (int i = 0; i < 8; ++i)
+            copy[i] = bits[i];
+        result = copy;
+    }
+    plane[block & 0xFF] = result;
+    return result;
+}
+
+#endif // CONFIG_XFREETYPE
+
+// vim: set sw=4 ts=4 et:
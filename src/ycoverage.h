@@ -0,0 +1,41 @@
+#ifndef YCOVERAGE_H
+#define YCOVERAGE_H
+
+#include <stdint.h>
+
+typedef struct _FcCharSet FcCharSet;
+
+// The code points for which a font has glyphs, as a table of planes
+// with a bitmap for every block of 256 code points. Each block is
+// taken from the fontconfig charset when it is first tested,
+// after which a lookup is a single bit test.
+class YCoverage {
+public:
+    explicit YCoverage(const FcCharSet* charset);
+    ~YCoverage();
+
+    bool has(unsigned code) const {
+        if (code >= Limit)
+            return false;
+        const uint32_t* const* plane = fPlanes[code >> 16];
+        const uint32_t* bits = plane ? plane[(code >> 8) & 0xFF] : nullptr;
+        if (bits == nullptr)
+            bits = fill(code >> 8);
+        return (bits[(code >> 5) & 7] >> (code & 31)) & 1;
+    }
+
+private:
+    YCoverage(const YCoverage&) = delete;
+    YCoverage& operator=(const YCoverage&) = delete;
+
+    const uint32_t* fill(unsigned block) const;
+
+    enum { Limit = 0x110000, Planes = Limit >> 16, Blocks = 256 };
+
+    const FcCharSet* fCharset;
+    mutable const uint32_t** fPlanes[Planes];
+};
+
+#endif
+
+// vim: set sw=4 ts=4 et:
@@ -59,6 +59,10 @@ private:
         XwcDrawString(xapp->display(), g.drawable(), fFontSet, g.handleX(),
                       x - g.xorigin(), y - g.yorigin(), text, count);
     }
+    void drawEllipsis(Graphics& g, int x, int y, const char* el) const {
+        XmbDrawString(xapp->display(), g.drawable(), fFontSet, g.handleX(),
+                      x - g.xorigin(), y - g.yorigin(), el, 3);
+    }
     void drawLimitRight(Graphics& g, int x, int y, wchar_t* text, int count, int width, int limit) const;
     void drawLimitLeft(Graphics& g, int x, int y, wchar_t* text, int count, int width, int limit) const;
 
@@ -173,30 +177,19 @@ void YCoreFont::drawGlyphs(Graphics& g, int x, int y,
         int ew = showEllipsis ? textWidth(el, 3) : 0;
         limit -= ew;
         if (limit > 0) {
-            int lo = 0, hi = len, pw = 0;
-            while (lo < hi) {
-                int pv = (lo + hi + 1) / 2;
-                pw = textWidth(str, pv);
-                if (pw <= limit) {
-                    lo = pv;
-                } else {
-                    hi = pv - 1;
-                }
+            // sum the widths of the characters while they fit
+            int lo = 0, pw = 0;
+            for (; lo < len; ++lo) {
+                int cw = XTextWidth(fFont, str + lo, 1);
+                if (pw + cw > limit)
+                    break;
+                pw += cw;
             }
-            if (pw > limit)
-                lo -= 1;
+            XDrawString(xapp->display(), g.drawable(), g.handleX(),
+                        x - g.xorigin(), y - g.yorigin(), str, lo);
             if (showEllipsis) {
-                size_t len = lo + 3;
-                char* buf = new char[len + 1];
-                memcpy(buf, str, lo);
-                memcpy(buf + lo, el, 3);
-                buf[len] = '\0';
-                XDrawString(xapp->display(), g.drawable(), g.handleX(),
-                            x - g.xorigin(), y - g.yorigin(), buf, lo + 3);
-                delete[] buf;
-            } else {
                 XDrawString(xapp->display(), g.drawable(), g.handleX(),
-                            x - g.xorigin(), y - g.yorigin(), str, lo);
+                            x + pw - g.xorigin(), y - g.yorigin(), el, 3);
             }
         }
     }
@@ -308,27 +301,18 @@ void YFontSet::drawLimitLeft(Graphics& g, int x, int y, wchar_t* text,
         limit -= ew;
     }
     if (0 < limit && 0 < count) {
-        int lo = 0, hi = count, pw = width;
-        while (lo < hi) {
-            int pv = (lo + hi + 1) / 2;
-            pw = textWidth(text, pv);
-            if (pw <= limit) {
-                lo = pv;
-            } else {
-                hi = pv - 1;
-            }
+        // sum the widths of the characters while they fit
+        int lo = 0, pw = 0;
+        for (; lo < count; ++lo) {
+            int cw = textWidth(text + lo, 1);
+            if (pw + cw > limit)
+                break;
+            pw += cw;
         }
-        if (pw > limit && lo > 0)
-            lo -= 1;
+        draw(g, x, y, text, lo);
         if (0 < ew) {
-            YWideString ellips(el, 3);
-            for (int i = 0; i < int(ellips.length()); ++i) {
-                if (lo < count) {
-                    text[lo++] = ellips[i];
-                }
-            }
+            drawEllipsis(g, x + pw, y, el);
         }
-        draw(g, x, y, text, lo);
     }
 }
 
@@ -338,34 +322,19 @@ void YFontSet::drawLimitRight(Graphics& g, int x, int y, wchar_t* text,
     const char* el = showEllipsis ? ellipsis() : "";
     int ew = showEllipsis ? textWidth(el, 3) : 0;
     if (0 < limit && 0 < count) {
-        int lo = 0, hi = count, pw = width + ew;
-        while (lo < hi) {
-            int pv = (lo + hi + 1) / 2;
-            pw = textWidth(text + count - pv, pv) + ew;
-            if (pw <= limit) {
-                lo = pv;
-            } else {
-                hi = pv - 1;
-            }
-        }
-        if (pw > limit && lo > 0) {
-            lo -= 1;
+        // sum the widths of the characters from the end while they fit
+        int lo = 0, pw = ew;
+        for (; lo < count; ++lo) {
+            int cw = textWidth(text + count - lo - 1, 1);
+            if (pw + cw > limit)
+                break;
+            pw += cw;
         }
+        int left = x + limit - pw;
         if (0 < ew) {
-            YWideString ellipsis(el, 3);
-            size_t ellen = ellipsis.length();
-            size_t size = lo + ellen;
-            wchar_t* copy = new wchar_t[size + 1];
-            memcpy(copy, ellipsis.data(), ellen * sizeof(wchar_t));
-            memcpy(copy + ellen, text + count - lo, lo * sizeof(wchar_t));
-            copy[size] = 0;
-            pw = textWidth(copy, size);
-            draw(g, x + limit - pw, y, copy, size);
-            delete[] copy;
-        } else {
-            pw = textWidth(text + count - lo, lo);
-            draw(g, x + limit - pw, y, text + count - lo, lo);
+            drawEllipsis(g, left, y, el);
         }
+        draw(g, left + ew, y, text + count - lo, lo);
     }
 }
 
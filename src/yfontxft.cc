@@ -9,6 +9,8 @@
 #include "yfontbase.h"
 #include "ylocale.h"
 #include "ybidi.h"
+#include "ycoverage.h"
+#include "ytrace.h"
 #include "intl.h"
 #include <stdio.h>
 #include <X11/Xft/Xft.h>
@@ -48,6 +50,7 @@ private:
     public:
         int extent;
 
+        TextParts(): parts(nullptr), length(0), extent(0) { }
         TextParts(int n): parts(new TextPart[n]), length(n), extent(0) { }
         void discard() { delete[] parts; parts = nullptr; length = 0; }
         TextPart* begin() const { return &parts[0]; }
@@ -56,12 +59,55 @@ private:
         int size() const { return length; }
     };
 
+    // A string in visual order with its runs per font,
+    // as it was converted from the bytes of the key.
+    struct TextLayout {
+        csmart bytes;
+        asmart<wchar_t> text;
+        TextParts parts;
+        asmart<int> sums;
+        unsigned long hash;
+        int size;
+        int length;
+        bool rtl;
+        int older, newer, next;
+    };
+
+    // The most recently laid out strings of this font.
+    class TextLayouts {
+    public:
+        TextLayouts() : fCount(0), fNewest(-1), fOldest(-1) { }
+        ~TextLayouts();
+        TextLayout* find(const char* str, int len, unsigned long hash);
+        TextLayout* insert(const char* str, int len, unsigned long hash);
+
+        enum { MaxCached = 256, Buckets = 512, MaxBytes = 1000 };
+
+    private:
+        void unlink(int index);
+        void unchain(int index);
+        void link(int index);
+
+        asmart<TextLayout> fEntries;
+        int fBuckets[Buckets];
+        int fCount, fNewest, fOldest;
+    };
+
     TextParts partitions(wchar_t* str, int len, int nparts = 0) const;
+    TextLayout* layout(const char* str, int len) const;
+
+    int advance(XftFont* font, wchar_t c) const;
+    int* advances(wchar_t* str, int len, const TextParts& parts) const;
 
+    void drawParts(Graphics& g, int x, int y, wchar_t* str, int len,
+                   bool rtl, const TextParts& parts, asmart<int>& sums,
+                   int limit);
     void drawLimitLeft(Graphics& g, XftFont* font, int x, int y,
-                       wchar_t* str, int len, int width, int limit) const;
+                       wchar_t* str, int len, const int* sums,
+                       int limit) const;
     void drawLimitRight(Graphics& g, XftFont* font, int x, int y,
-                        wchar_t* str, int len, int width, int limit) const;
+                        wchar_t* str, int len, const int* sums,
+                        int limit) const;
     void drawString(Graphics& g, XftFont* font, int x, int y,
                     wchar_t* str, int len) const {
         switch (int(true)) {
@@ -89,8 +135,15 @@ private:
         return showEllipsis && supports(utf32ellipsis) ? utf32ellipsis : None;
     }
 
+    bool covers(XftFont** font, wchar_t c) const {
+        return fCoverage[int(font - fFonts)]->has(unsigned(c));
+    }
+    void initCoverage();
+
     int fFontCount, fAscent, fDescent;
     XftFont** fFonts;
+    YObjectArray<YCoverage> fCoverage;
+    mutable TextLayouts fLayouts;
 };
 
 /******************************************************************************/
@@ -141,6 +194,7 @@ YXftFont::YXftFont(mstring name, bool use_xlfd):
         fAscent = int((accum + (numer / 2)) / numer);
         fDescent = int((decum + (numer / 2)) / numer);
     }
+    initCoverage();
 }
 
 YXftFont::YXftFont(XftFont* font) :
@@ -150,6 +204,12 @@ YXftFont::YXftFont(XftFont* font) :
     fFonts(new XftFont* [1])
 {
     *fFonts = font;
+    initCoverage();
+}
+
+void YXftFont::initCoverage() {
+    for (int i = 0; i < fFontCount; ++i)
+        fCoverage.append(new YCoverage(fFonts[i]->charset));
 }
 
 YXftFont::~YXftFont() {
@@ -168,20 +228,28 @@ int YXftFont::textWidth(wchar_t* text, int length) const {
 
 int YXftFont::textWidth(const char* str, int len) const {
     int width = 0;
-    if (0 < len) {
+    if (len > TextLayouts::MaxBytes) {
         YWideString string(str, len);
         YBidi bidi(string.data(), string.length());
         width = textWidth(bidi.string(), int(bidi.length()));
     }
+    else if (0 < len) {
+        width = layout(str, len)->parts.extent;
+    }
     return width;
 }
 
 void YXftFont::drawGlyphs(Graphics& g, int x, int y,
                           const char* str, int len, int limit) {
-    if (0 < len && 0 <= limit) {
+    if (len > TextLayouts::MaxBytes && 0 <= limit) {
         YWideString wide(str, len);
         drawGlyphs(g, x, y, wide.data(), int(wide.length()), limit);
     }
+    else if (0 < len && 0 <= limit) {
+        TextLayout* lay = layout(str, len);
+        drawParts(g, x, y, lay->text, lay->length, lay->rtl,
+                  lay->parts, lay->sums, limit);
+    }
 }
 
 void YXftFont::drawGlyphs(Graphics& g, int x, int y,
@@ -189,147 +257,170 @@ void YXftFont::drawGlyphs(Graphics& g, int x, int y,
     if (0 < len && 0 <= limit) {
         YBidi bidi(data, len);
         TextParts parts = partitions(bidi.string(), int(bidi.length()));
-        if (limit == 0) {
-            if (bidi.isRTL() && int(g.rwidth()) < parts.extent) {
-                limit = int(g.rwidth());
+        asmart<int> sums;
+        drawParts(g, x, y, bidi.string(), int(bidi.length()),
+                  bidi.isRTL(), parts, sums, limit);
+        parts.discard();
+    }
+}
+
+void YXftFont::drawParts(Graphics& g, int x, int y, wchar_t* str, int len,
+                         bool rtl, const TextParts& parts, asmart<int>& sums,
+                         int limit)
+{
+    if (limit == 0) {
+        if (rtl && int(g.rwidth()) < parts.extent) {
+            limit = int(g.rwidth());
+        }
+    } else if (parts.extent <= limit && rightToLeft == false) {
+        limit = 0;
+    }
+    if (limit == 0) {
+        wchar_t* xstr = str;
+        int xpos = 0;
+        for (TextPart& p : parts) {
+            if (p.font) {
+                drawString(g, p.font, x + xpos, y, xstr, p.length);
             }
-        } else if (parts.extent <= limit && rightToLeft == false) {
-            limit = 0;
+            xstr += p.length;
+            xpos += p.width;
         }
-        if (limit == 0) {
-            wchar_t* xstr = bidi.string();
+    }
+    else {
+        bool clipping = (x - g.xorigin() + limit < int(g.rwidth()));
+        if (clipping) {
+            XRectangle clip = {
+                short(x - g.xorigin()),
+                short(y - ascent() - g.yorigin()),
+                (unsigned short) limit,
+                (unsigned short) g.rheight()
+            };
+            g.setClipRectangles(&clip, 1);
+        }
+        if (sums == nullptr && limit < parts.extent) {
+            sums = advances(str, len, parts);
+        }
+
+        if (rtl == false) {
+            wchar_t* xstr = str;
             int xpos = 0;
             for (TextPart& p : parts) {
-                if (p.font) {
-                    drawString(g, p.font, x + xpos, y, xstr, p.length);
+                if (p.font && xpos < limit) {
+                    if (limit - xpos >= p.width) {
+                        drawString(g, p.font, x + xpos, y, xstr, p.length);
+                    } else {
+                        drawLimitLeft(g, p.font, x + xpos, y, xstr, p.length,
+                                      &sums[xstr - str], limit - xpos);
+                        break;
+                    }
                 }
                 xstr += p.length;
                 xpos += p.width;
             }
-        }
-        else {
-            bool clipping = (x - g.xorigin() + limit < int(g.rwidth()));
-            if (clipping) {
-                XRectangle clip = {
-                    short(x - g.xorigin()),
-                    short(y - ascent() - g.yorigin()),
-                    (unsigned short) limit,
-                    (unsigned short) g.rheight()
-                };
-                g.setClipRectangles(&clip, 1);
-            }
-
-            if (bidi.isRTL() == false) {
-                wchar_t* xstr = bidi.string();
-                int xpos = 0;
-                for (TextPart& p : parts) {
-                    if (p.font && xpos < limit) {
-                        if (limit - xpos >= p.width) {
-                            drawString(g, p.font, x + xpos, y, xstr, p.length);
-                        } else {
-                            drawLimitLeft(g, p.font, x + xpos, y, xstr,
-                                          p.length, p.width, limit - xpos);
-                            break;
-                        }
-                    }
-                    xstr += p.length;
-                    xpos += p.width;
-                }
-            } else {
-                wchar_t* xstr = bidi.string() + bidi.length();
-                int xpos = limit;
-                for (TextPart* q = parts.end(); --q >= parts.begin(); ) {
-                    TextPart& p(*q);
-                    if (p.font && 0 < xpos) {
-                        xstr -= p.length;
-                        int left = xpos - p.width;
-                        if (left >= 0) {
-                            drawString(g, p.font, x + left,
-                                       y, xstr, p.length);
-                        } else {
-                            drawLimitRight(g, p.font, x, y, xstr,
-                                           p.length, p.width, xpos);
-                            break;
-                        }
-                        xpos -= p.width;
+        } else {
+            wchar_t* xstr = str + len;
+            int xpos = limit;
+            for (TextPart* q = parts.end(); --q >= parts.begin(); ) {
+                TextPart& p(*q);
+                if (p.font && 0 < xpos) {
+                    xstr -= p.length;
+                    int left = xpos - p.width;
+                    if (left >= 0) {
+                        drawString(g, p.font, x + left,
+                                   y, xstr, p.length);
+                    } else {
+                        drawLimitRight(g, p.font, x, y, xstr, p.length,
+                                       &sums[xstr - str], xpos);
+                        break;
                     }
+                    xpos -= p.width;
                 }
             }
+        }
 
-            if (clipping) {
-                g.resetClip();
-            }
+        if (clipping) {
+            g.resetClip();
         }
+    }
+}
 
-        parts.discard();
+// How many characters at the start of a text fit in limit,
+// given the widths of its prefixes in sums[0..count].
+static int fitLeft(const int* sums, int count, int limit) {
+    int lo = 0, hi = count;
+    while (lo < hi) {
+        int pv = (lo + hi + 1) / 2;
+        if (sums[pv] - sums[0] <= limit) {
+            lo = pv;
+        } else {
+            hi = pv - 1;
+        }
     }
+    return lo;
+}
+
+// How many characters at the end of a text fit in limit.
+static int fitRight(const int* sums, int count, int limit) {
+    int lo = 0, hi = count;
+    while (lo < hi) {
+        int pv = (lo + hi + 1) / 2;
+        if (sums[count] - sums[count - pv] <= limit) {
+            lo = pv;
+        } else {
+            hi = pv - 1;
+        }
+    }
+    return lo;
+}
+
+int YXftFont::advance(XftFont* font, wchar_t c) const {
+    FT_UInt glyph = XftCharIndex(xapp->display(), font, FcChar32(c));
+    XGlyphInfo extents;
+    XftGlyphExtents(xapp->display(), font, &glyph, 1, &extents);
+    return extents.xOff;
+}
+
+// The widths of all prefixes of the text, from the glyph advances.
+int* YXftFont::advances(wchar_t* str, int len, const TextParts& parts) const {
+    int* sums = new int[len + 1];
+    int i = 0;
+    sums[0] = 0;
+    for (const TextPart& p : parts) {
+        for (int k = 0; k < p.length && i < len; ++k, ++i) {
+            sums[i + 1] = sums[i] + (p.font ? advance(p.font, str[i]) : 0);
+        }
+    }
+    return sums;
 }
 
 void YXftFont::drawLimitLeft(Graphics& g, XftFont* font, int x, int y,
-                             wchar_t* str, int len, int width, int limit) const
+                             wchar_t* str, int len, const int* sums,
+                             int limit) const
 {
     wchar_t el = ellipsis();
-    int ew = el ? textWidth(&el, 1) : None;
-    if (ew) {
-        limit -= ew;
-    }
+    int ew = el ? advance(font, el) : 0;
+    limit -= ew;
     if (0 < limit && 0 < len) {
-        int lo = 0, hi = len, pw = width;
-        while (lo < hi) {
-            int pv = (lo + hi + 1) / 2;
-            pw = textWidth(str, pv);
-            if (pw <= limit) {
-                lo = pv;
-            } else {
-                hi = pv - 1;
-            }
-        }
-        if (pw > limit && lo > 0)
-            lo -= 1;
-        if (0 < ew) {
-            const int size = lo + 2;
-            asmart<wchar_t> copy(new wchar_t[size]);
-
-            memcpy(copy, str, lo * sizeof(wchar_t));
-            copy[lo] = el;
-            copy[lo + 1] = 0;
-            drawString(g, font, x, y, copy, lo + 1);
-        } else {
-            drawString(g, font, x, y, str, lo);
+        int fit = fitLeft(sums, len, limit);
+        drawString(g, font, x, y, str, fit);
+        if (el) {
+            drawString(g, font, x + sums[fit] - sums[0], y, &el, 1);
         }
     }
 }
 
 void YXftFont::drawLimitRight(Graphics& g, XftFont* font, int x, int y,
-                              wchar_t* str, int len, int width, int limit) const
+                              wchar_t* str, int len, const int* sums,
+                              int limit) const
 {
     wchar_t el = ellipsis();
-    int ew = el ? textWidth(&el, 1) : None;
+    int ew = el ? advance(font, el) : 0;
     if (0 < limit && 0 < len) {
-        int lo = 0, hi = len, pw = width + ew;
-        while (lo < hi) {
-            int pv = (lo + hi + 1) / 2;
-            pw = textWidth(str + len - pv, pv) + ew;
-            if (pw <= limit) {
-                lo = pv;
-            } else {
-                hi = pv - 1;
-            }
-        }
-        if (pw > limit && lo > 0) {
-            lo -= 1;
-        }
-        if (0 < ew) {
-            const int size = lo + 2;
-            asmart<wchar_t> copy(new wchar_t[size]);
-            memcpy(copy + 1, str + len - lo, lo * sizeof(wchar_t));
-            copy[0] = el;
-            copy[lo + 1] = 0;
-            pw = textWidth(copy, lo + 1);
-            drawString(g, font, x + limit - pw, y, copy, lo + 1);
-        } else {
-            pw = textWidth(str + len - lo, lo);
-            drawString(g, font, x + limit - pw, y, str + len - lo, lo);
+        int fit = fitRight(sums, len, limit - ew);
+        int left = x + limit - (sums[len] - sums[len - fit]);
+        drawString(g, font, left, y, str + len - fit, fit);
+        if (el) {
+            drawString(g, font, left - ew, y, &el, 1);
         }
     }
 }
@@ -340,7 +431,7 @@ bool YXftFont::supports(unsigned utf32char) const {
 
     // be conservative, only report when all font candidates can do it
     for (int i = 0; i < fFontCount; ++i) {
-        if (!XftCharExists(xapp->display(), fFonts[i], utf32char))
+        if (!fCoverage[i]->has(utf32char))
             return false;
     }
     return true;
@@ -360,8 +451,7 @@ YXftFont::TextParts YXftFont::partitions(wchar_t* str, int len, int nparts) cons
     for (; c < len; ++c) {
         XftFont ** probe(fFonts);
 
-        while (probe < endFont
-            && !XftCharExists(xapp->display(), *probe, str[c]))
+        while (probe < endFont && !covers(probe, str[c]))
             ++probe;
 
         if (probe != font) {
@@ -384,7 +474,7 @@ YXftFont::TextParts YXftFont::partitions(wchar_t* str, int len, int nparts) cons
 
         if (probe < endFont) {
             while (c + 1 < len && str[c + 1] == ' ' &&
-                   XftCharExists(xapp->display(), *probe, str[c + 1])) {
+                   covers(probe, str[c + 1])) {
                 ++c;
             }
         }
@@ -404,6 +494,139 @@ YXftFont::TextParts YXftFont::partitions(wchar_t* str, int len, int nparts) cons
     return parts;
 }
 
+static unsigned long layoutsReused, layoutsCreated;
+static timeval reuseTime, createTime;
+
+YXftFont::TextLayout* YXftFont::layout(const char* str, int len) const {
+    const timeval start = monotime();
+    unsigned long hash = 5381;
+    for (int i = 0; i < len; ++i)
+        hash = 33 * hash ^ (unsigned char) str[i];
+
+    TextLayout* lay = fLayouts.find(str, len, hash);
+    if (lay) {
+        ++layoutsReused;
+        reuseTime += monotime() - start;
+    } else {
+        ++layoutsCreated;
+        lay = fLayouts.insert(str, len, hash);
+        YWideString wide(str, len);
+        YBidi bidi(wide.data(), wide.length());
+        lay->length = int(bidi.length());
+        lay->text = new wchar_t[lay->length + 1];
+        memcpy(lay->text, bidi.string(), lay->length * sizeof(wchar_t));
+        lay->text[lay->length] = 0;
+        lay->rtl = bidi.isRTL();
+        lay->parts = partitions(lay->text, lay->length);
+        lay->sums = nullptr;
+        createTime += monotime() - start;
+    }
+    if ((layoutsReused + layoutsCreated) % 1000 == 0 &&
+        YTrace::traces("font"))
+    {
+        // what the reused layouts would have cost to lay out again
+        double create = toDouble(createTime);
+        double reuse = toDouble(reuseTime);
+        double saved = create * layoutsReused / layoutsCreated - reuse;
+        tlog("font: %lu text layouts reused in %.1f ms, "
+             "%lu laid out in %.1f ms, %.1f ms saved",
+             layoutsReused, 1e3 * reuse, layoutsCreated, 1e3 * create,
+             1e3 * saved);
+    }
+    return lay;
+}
+
+YXftFont::TextLayouts::~TextLayouts() {
+    for (int i = 0; i < fCount; ++i)
+        fEntries[i].parts.discard();
+}
+
+YXftFont::TextLayout* YXftFont::TextLayouts::find(const char* str, int len,
+                                                  unsigned long hash)
+{
+    if (fEntries) {
+        for (int i = fBuckets[hash % Buckets]; 0 <= i; ) {
+            TextLayout& e = fEntries[i];
+            if (e.hash == hash && e.size == len &&
+                memcmp(e.bytes, str, len) == 0)
+            {
+                if (i != fNewest) {
+                    unlink(i);
+                    link(i);
+                }
+                return &e;
+            }
+            i = e.next;
+        }
+    }
+    return nullptr;
+}
+
+YXftFont::TextLayout* YXftFont::TextLayouts::insert(const char* str, int len,
+                                                    unsigned long hash)
+{
+    if (fEntries == nullptr) {
+        fEntries = new TextLayout[MaxCached];
+        for (int& b : fBuckets)
+            b = -1;
+    }
+
+    int i;
+    if (fCount < MaxCached) {
+        i = fCount++;
+    } else {
+        i = fOldest;
+        unchain(i);
+        unlink(i);
+        fEntries[i].parts.discard();
+    }
+
+    TextLayout& e = fEntries[i];
+    e.bytes = new char[len];
+    memcpy(e.bytes, str, len);
+    e.size = len;
+    e.hash = hash;
+    e.next = fBuckets[hash % Buckets];
+    fBuckets[hash % Buckets] = i;
+    link(i);
+    return &e;
+}
+
+void YXftFont::TextLayouts::unchain(int index) {
+    TextLayout& e = fEntries[index];
+    for (int* p = &fBuckets[e.hash % Buckets]; 0 <= *p;
+         p = &fEntries[*p].next)
+    {
+        if (*p == index) {
+            *p = e.next;
+            break;
+        }
+    }
+}
+
+void YXftFont::TextLayouts::unlink(int index) {
+    TextLayout& e = fEntries[index];
+    if (0 <= e.newer)
+        fEntries[e.newer].older = e.older;
+    else
+        fNewest = e.older;
+    if (0 <= e.older)
+        fEntries[e.older].newer = e.newer;
+    else
+        fOldest = e.newer;
+}
+
+void YXftFont::TextLayouts::link(int index) {
+    TextLayout& e = fEntries[index];
+    e.newer = -1;
+    e.older = fNewest;
+    if (0 <= fNewest)
+        fEntries[fNewest].newer = index;
+    else
+        fOldest = index;
+    fNewest = index;
+}
+
 YFontBase* getXftFontXlfd(const char* name) {
     YXftFont* font = new YXftFont(name, true);
     if (font && !font->valid()) {
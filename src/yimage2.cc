@@ -343,8 +343,7 @@ ref<YPixmap> YImage2::renderToPixmap(unsigned depth, bool premult) {
 
             pixmap = XCreatePixmap(xapp->display(), xapp->root(),
                                    width, height, depth);
-            XPutImage(xapp->display(), pixmap, gc(pixmap, depth), image,
-                      0, 0, 0, 0, width, height);
+            xapp->putImage(pixmap, gc(pixmap, depth), image, 0, 0);
 
             mask = XCreatePixmap(xapp->display(), xapp->root(),
                                  width, height, 1);
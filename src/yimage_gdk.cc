@@ -330,8 +330,7 @@ ref<YPixmap> YImageGDK::renderToPixmap(unsigned depth, bool premult) {
             pixmap = XCreatePixmap(xapp->display(), xapp->root(),
                                    width, height, depth);
             GC gc = XCreateGC(xapp->display(), pixmap, None, None);
-            XPutImage(xapp->display(), pixmap, gc, image,
-                      0, 0, 0, 0, width, height);
+            xapp->putImage(pixmap, gc, image, 0, 0);
             XFreeGC(xapp->display(), gc);
 
             mask = XCreatePixmap(xapp->display(), xapp->root(),
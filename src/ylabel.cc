@@ -57,7 +57,7 @@ void YLabel::paint(Graphics &g, const YRect &/*r*/) {
     ref<YImage> gradient(getGradient());
 
     if (gradient != null)
-        g.drawImage(gradient, x() - 1, y() - 1, width(), height(), 0, 0);
+        g.drawCached(gradient, x() - 1, y() - 1, width(), height(), 0, 0);
     else
     if (dialogbackPixmap != null)
         g.fillPixmap(dialogbackPixmap, 0, 0, width(), height(), x() - 1, y() - 1);
@@ -0,0 +1,122 @@
+/*
+ *  IceWM - Dispatch latency histograms
+ *
+ *  Release under terms of the GNU Library General Public License
+ */
+
+#include "config.h"
+#include "ylatency.h"
+#include "yprefs.h"
+#include "ytime.h"
+#include "base.h"
+#include <cxxabi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+YLatency* YLatency::fFirst;
+
+YLatency::YLatency(const char* kind, bool typeNames) :
+    fKind(kind),
+    fTypeNames(typeNames),
+    fNext(fFirst)
+{
+    fFirst = this;
+}
+
+YLatency::~YLatency() {
+    for (YLatency** p = &fFirst; *p; p = &(*p)->fNext) {
+        if (*p == this) {
+            *p = fNext;
+            break;
+        }
+    }
+}
+
+YLatency::Histogram* YLatency::histogram(const char* name) {
+    for (Histogram& h : fHistograms)
+        if (h.name == name)
+            return &h;
+    Histogram h;
+    memset(&h, 0, sizeof h);
+    h.name = name;
+    fHistograms.append(h);
+    return &fHistograms[fHistograms.getCount() - 1];
+}
+
+char* YLatency::realName(const char* name) const {
+    int status = 0;
+    return fTypeNames
+        ? abi::__cxa_demangle(name, nullptr, nullptr, &status)
+        : nullptr;
+}
+
+long YLatency::account(const char* name, const timeval& start) {
+    timeval now = monotime();
+    long micros = (now.tv_sec - start.tv_sec) * 1000000L
+                + (now.tv_usec - start.tv_usec);
+    if (micros < 0)
+        micros = 0;
+
+    int k = 0;
+    while (k + 1 < Buckets && (16L << k) <= micros)
+        ++k;
+
+    Histogram* h = histogram(name);
+    h->count++;
+    h->total += micros;
+    h->buckets[k]++;
+    if (h->longest < micros)
+        h->longest = micros;
+    return micros;
+}
+
+bool YLatency::isSlow(long micros) {
+    return SlowDispatchThreshold > 0 && SlowDispatchThreshold * 1000L <= micros;
+}
+
+bool YLatency::record(const char* name, const timeval& start) {
+    long micros = account(name, start);
+    if (isSlow(micros)) {
+        char* real = realName(name);
+        tlog("slow %s dispatch: %s took %ld ms",
+             fKind, real ? real : name, micros / 1000L);
+        free(real);
+        return true;
+    }
+    return false;
+}
+
+void YLatency::report() const {
+    for (const Histogram& h : fHistograms) {
+        char* real = realName(h.name);
+        char line[512];
+        int len = snprintf(line, sizeof line,
+                           "%s %s: %u calls, avg %lld us, max %ld us |",
+                           fKind, real ? real : h.name, h.count,
+                           h.total / max(1U, h.count), h.longest);
+        free(real);
+        for (int k = 0; k < Buckets && len < int(sizeof line); ++k) {
+            if (h.buckets[k] == 0)
+                continue;
+            long limit = 16L << k;
+            const char* op = k + 1 < Buckets ? "<" : ">=";
+            if (k + 1 == Buckets)
+                limit = 16L << (k - 1);
+            if (limit < 1000)
+                len += snprintf(line + len, sizeof line - len,
+                                " %s%ldus:%u", op, limit, h.buckets[k]);
+            else
+                len += snprintf(line + len, sizeof line - len,
+                                " %s%ldms:%u", op, limit / 1000, h.buckets[k]);
+        }
+        tlog("%s", line);
+    }
+}
+
+void YLatency::reportAll() {
+    for (YLatency* lat = fFirst; lat; lat = lat->fNext)
+        lat->report();
+}
+
+// vim: set sw=4 ts=4 et:
@@ -0,0 +1,55 @@
+#ifndef YLATENCY_H
+#define YLATENCY_H
+
+#include "yarray.h"
+#include <sys/time.h>
+
+// Log bucketed histograms of the time spent by event handlers,
+// keyed by a handler name which must be a stable pointer.
+// Names from typeid are demangled when they are reported.
+// Bucket k counts dispatches of less than 16 << k microseconds.
+class YLatency {
+public:
+    YLatency(const char* kind, bool typeNames);
+    ~YLatency();
+
+    // account a dispatch which began at start,
+    // return true if it took SlowDispatchThreshold or longer
+    bool record(const char* name, const timeval& start);
+    // account a dispatch without logging, return its microseconds
+    long account(const char* name, const timeval& start);
+    static bool isSlow(long micros);
+
+    void report() const;
+    void reset() { fHistograms.clear(); }
+
+    // dump the histograms of all dispatchers
+    static void reportAll();
+
+private:
+    enum { Buckets = 16 };
+
+    struct Histogram {
+        const char* name;
+        unsigned count;
+        long longest;
+        long long total;
+        unsigned buckets[Buckets];
+    };
+
+    Histogram* histogram(const char* name);
+    char* realName(const char* name) const;
+
+    const char* fKind;
+    bool fTypeNames;
+    YArray<Histogram> fHistograms;
+    YLatency* fNext;
+    static YLatency* fFirst;
+
+    YLatency(const YLatency&) = delete;
+    YLatency& operator=(const YLatency&) = delete;
+};
+
+#endif
+
+// vim: set sw=4 ts=4 et:
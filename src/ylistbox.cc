@@ -533,7 +533,7 @@ void YListBox::paintItem(Graphics &g, int n) {
         g.fillRect(0, y - fOffsetY, width(), lh);
     } else {
         if (fGradient != null)
-            g.drawImage(fGradient, 0, y - fOffsetY, width(), lh,
+            g.drawCached(fGradient, 0, y - fOffsetY, width(), lh,
                          0, y - fOffsetY);
         else if (listbackPixmap != null)
             g.fillPixmap(listbackPixmap, 0, y - fOffsetY, width(), lh);
@@ -589,7 +589,7 @@ void YListBox::paint(Graphics &g, const YRect &r) {
 
     if (y < height()) {
         if (fGradient != null)
-            g.drawImage(fGradient, 0, y, width(), height() - y, 0, y);
+            g.drawCached(fGradient, 0, y, width(), height() - y, 0, y);
         else if (listbackPixmap != null)
             g.fillPixmap(listbackPixmap, 0, y, width(), height() - y);
         else {
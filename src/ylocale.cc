@@ -26,6 +26,9 @@
 #include <X11/Xlib.h>
 #include <iconv.h>
 #include <ctype.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 const iconv_t invalid = iconv_t(-1);
 
@@ -155,6 +158,9 @@ iconv_t YConverter::getConverter(const char* from, const char**& to) {
 #endif
 
 YLocale* YLocale::instance;
+#ifdef CONFIG_I18N
+bool YLocale::reportErrors = true;
+#endif
 
 YLocale::YLocale(const char* localeName)
     : converter(nullptr)
@@ -183,11 +189,159 @@ YLocale::~YLocale() {
 }
 
 #ifdef CONFIG_I18N
+
+// Decode UTF-8 up to the first malformed sequence, like iconv does.
+// Sets error to EILSEQ for an invalid and EINVAL for an incomplete one.
+// Like glibc, a truncated sequence is incomplete when the bytes so far
+// could start a longer form, even when that form is beyond Unicode.
+static size_t decodeUTF8(const char* lStr, size_t lLen, wchar_t* uStr,
+                         int& error)
+{
+    const unsigned char* src = (const unsigned char *) lStr;
+    size_t i = 0, n = 0;
+    error = 0;
+    while (i < lLen) {
+#ifdef __SSE2__
+        // widen sixteen ASCII bytes at a time
+        while (sizeof(wchar_t) == 4 && i + 16 <= lLen) {
+            __m128i chunk = _mm_loadu_si128((const __m128i *) (src + i));
+            if (_mm_movemask_epi8(chunk))
+                break;
+            const __m128i zero = _mm_setzero_si128();
+            __m128i lo = _mm_unpacklo_epi8(chunk, zero);
+            __m128i hi = _mm_unpackhi_epi8(chunk, zero);
+            __m128i* out = (__m128i *) (uStr + n);
+            _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(lo, zero));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(lo, zero));
+            _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(hi, zero));
+            _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(hi, zero));
+            i += 16;
+            n += 16;
+        }
+        if (i == lLen)
+            break;
+#endif
+        unsigned c = src[i];
+        if (c < 0x80) {
+            uStr[n++] = wchar_t(c);
+            i += 1;
+            continue;
+        }
+
+        size_t extra;
+        unsigned least;
+        if (0xC2 <= c && c <= 0xDF) {
+            extra = 1, least = 0x80, c &= 0x1F;
+        } else if (0xE0 <= c && c <= 0xEF) {
+            extra = 2, least = 0x800, c &= 0x0F;
+        } else if (0xF0 <= c && c <= 0xF7) {
+            extra = 3, least = 0x10000, c &= 0x07;
+        } else if (0xF8 <= c && c <= 0xFB) {
+            extra = 4, least = 0x200000, c &= 0x03;
+        } else if (0xFC <= c && c <= 0xFD) {
+            extra = 5, least = 0x4000000, c &= 0x01;
+        } else {
+            error = EILSEQ;
+            break;
+        }
+        for (size_t k = 1; k <= extra; ++k) {
+            if (i + k == lLen) {
+                error = EINVAL;
+                break;
+            }
+            if ((src[i + k] & 0xC0) != 0x80) {
+                error = EILSEQ;
+                break;
+            }
+            c = (c << 6) | (src[i + k] & 0x3F);
+        }
+        if (error == 0 && (c < least || c > 0x10FFFF ||
+                           (0xD800 <= c && c <= 0xDFFF)))
+        {
+            error = EILSEQ;
+        }
+        if (error)
+            break;
+        uStr[n++] = wchar_t(c);
+        i += 1 + extra;
+    }
+    return n;
+}
+
+// Encode as UTF-8, with a question mark for what is not Unicode.
+// The destination must have room for four bytes per character.
+static size_t encodeUTF8(const wchar_t* uStr, size_t uLen, char* lStr) {
+    unsigned char* dst = (unsigned char *) lStr;
+    size_t i = 0, n = 0;
+    while (i < uLen) {
+#ifdef __SSE2__
+        // narrow sixteen ASCII characters at a time
+        while (sizeof(wchar_t) == 4 && i + 16 <= uLen) {
+            const __m128i* in = (const __m128i *) (uStr + i);
+            __m128i a = _mm_loadu_si128(in + 0);
+            __m128i b = _mm_loadu_si128(in + 1);
+            __m128i c = _mm_loadu_si128(in + 2);
+            __m128i d = _mm_loadu_si128(in + 3);
+            __m128i high = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+            high = _mm_and_si128(high, _mm_set1_epi32(~0x7F));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(high,
+                                  _mm_setzero_si128())) != 0xFFFF)
+                break;
+            __m128i packed = _mm_packus_epi16(_mm_packs_epi32(a, b),
+                                              _mm_packs_epi32(c, d));
+            _mm_storeu_si128((__m128i *) (dst + n), packed);
+            i += 16;
+            n += 16;
+        }
+        if (i == uLen)
+            break;
+#endif
+        unsigned c = unsigned(uStr[i++]);
+        if (c < 0x80) {
+            dst[n++] = (unsigned char) c;
+        } else if (c < 0x800) {
+            dst[n++] = (unsigned char) (0xC0 | (c >> 6));
+            dst[n++] = (unsigned char) (0x80 | (c & 0x3F));
+        } else if (c < 0x10000) {
+            if (0xD800 <= c && c <= 0xDFFF) {
+                dst[n++] = '?';
+                continue;
+            }
+            dst[n++] = (unsigned char) (0xE0 | (c >> 12));
+            dst[n++] = (unsigned char) (0x80 | ((c >> 6) & 0x3F));
+            dst[n++] = (unsigned char) (0x80 | (c & 0x3F));
+        } else if (c <= 0x10FFFF) {
+            dst[n++] = (unsigned char) (0xF0 | (c >> 18));
+            dst[n++] = (unsigned char) (0x80 | ((c >> 12) & 0x3F));
+            dst[n++] = (unsigned char) (0x80 | ((c >> 6) & 0x3F));
+            dst[n++] = (unsigned char) (0x80 | (c & 0x3F));
+        } else {
+            dst[n++] = '?';
+        }
+    }
+    return n;
+}
+
+static void invalidMultibyte(const char* lStr, int error) {
+    static unsigned count, shift;
+    if (++count >= (1U << shift)) {
+        ++shift;
+        warn(_("Invalid multibyte string \"%s\": %s"), lStr, strerror(error));
+    }
+}
+
 char* YLocale::localeString(const wchar_t* uStr, size_t uLen, size_t &lLen) {
     PRECONDITION(instance);
     if (uStr == nullptr)
         return nullptr;
 
+    if (instance->codesetUTF8) {
+        char* lStr = new char[4 * uLen + 1];
+        lLen = encodeUTF8(uStr, uLen, lStr);
+        lStr[lLen] = '\0';
+        return lStr;
+    }
+
     iconv(instance->converter->localer(), nullptr, nullptr, nullptr, nullptr);
 
     size_t lSize = 4 * uLen;
@@ -200,7 +354,7 @@ char* YLocale::localeString(const wchar_t* uStr, size_t uLen, size_t &lLen) {
     errno = 0;
     size_t count = iconv(instance->converter->localer(),
                          &inbuf, &inlen, &outbuf, &outlen);
-    if (count == size_t(-1)) {
+    if (count == size_t(-1) && reportErrors) {
         static unsigned count, shift;
         if (++count <= 2 || (count - 2) >= (1U << shift)) {
             ++shift;
@@ -222,6 +376,17 @@ wchar_t* YLocale::unicodeString(const char* lStr, size_t const lLen,
     if (lStr == nullptr)
         return nullptr;
 
+    if (instance->codesetUTF8) {
+        wchar_t* uStr = new wchar_t[lLen + 1];
+        int error = 0;
+        uLen = decodeUTF8(lStr, lLen, uStr, error);
+        uStr[uLen] = 0;
+        if (error && reportErrors)
+            invalidMultibyte(lStr, error);
+        errno = error;
+        return uStr;
+    }
+
     iconv(instance->converter->unicode(), nullptr, nullptr, nullptr, nullptr);
 
     wchar_t* uStr(new wchar_t[lLen + 1]);
@@ -232,13 +397,11 @@ wchar_t* YLocale::unicodeString(const char* lStr, size_t const lLen,
     errno = 0;
     size_t count = iconv(instance->converter->unicode(),
                          &inbuf, &inlen, &outbuf, &outlen);
-    if (count == size_t(-1)) {
-        static unsigned count, shift;
-        if (++count >= (1U << shift)) {
-            ++shift;
-            warn(_("Invalid multibyte string \"%s\": %s"), lStr, strerror(errno));
-        }
+    int error = (count == size_t(-1)) ? errno : 0;
+    if (error && reportErrors) {
+        invalidMultibyte(lStr, error);
     }
+    errno = error;
 
     *(reinterpret_cast<wchar_t *>(outbuf)) = 0;
     uLen = reinterpret_cast<wchar_t *>(outbuf) - uStr;
@@ -22,7 +22,10 @@ public:
 
 #ifdef CONFIG_I18N
     static char* localeString(const wchar_t* uStr, size_t uLen, size_t& lLen);
+    // leave errno at zero or at the error of a failed conversion
     static wchar_t* unicodeString(const char* lStr, size_t lLen, size_t& uLen);
+    // whether failed conversions are reported, which is the default
+    static void warnings(bool enable) { reportErrors = enable; }
 #else
     static wchar_t* wideCharString(const char* str, size_t len, size_t& out);
 #endif
@@ -36,6 +39,9 @@ private:
     void getDirection();
 
     static YLocale* instance;
+#ifdef CONFIG_I18N
+    static bool reportErrors;
+#endif
 };
 
 #endif
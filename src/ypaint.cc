@@ -9,6 +9,8 @@
 #include "yprefs.h"
 #include "yfontbase.h"
 #include "ascii.h"
+#include "ytrace.h"
+#include "ytimer.h"
 #include "intl.h"
 #include <stdlib.h>
 
@@ -24,9 +26,242 @@ static inline Display* display()  { return xapp->display(); }
 
 /******************************************************************************/
 
+// Graphics are short-lived, but their server resources need not be.
+// GCs are pooled per depth and reset to their defaults when reused.
+// The XftDraw and Picture of a pixmap are kept for the next paint,
+// for a bounded number of the most recently painted pixmaps.
+struct GraphicsEntry {
+    Drawable drawable;
+    unsigned depth;
+    unsigned used;
+    int users;
+    bool drawing;
+    bool forgotten;
+#ifdef CONFIG_XFREETYPE
+    XftDraw* xft;
+#endif
+    Picture picture;
+};
+
+class GraphicsCache {
+public:
+    GraphicsCache() : fPools(), fEntries(), fCount(0), fClock(0),
+        fGraphics(0), fSaved(0), fPrimitives(0), fBatches(0),
+        fRendered(0), fReused(0), fRenderTime(zerotime()),
+        fReuseTime(zerotime()) { }
+
+    GC acquire(Drawable drawable, unsigned depth,
+               unsigned long mask, XGCValues* values);
+    void release(GC gc, unsigned depth);
+
+    GraphicsEntry* attach(Drawable drawable, unsigned depth);
+    void detach(GraphicsEntry* entry);
+    void forget(Drawable drawable);
+    void saved() { fSaved += 2; }
+    void batched(unsigned primitives, unsigned batches) {
+        fPrimitives += primitives;
+        fBatches += batches;
+    }
+    void rendered(bool reused, const timeval& start) {
+        ++(reused ? fReused : fRendered);
+        (reused ? fReuseTime : fRenderTime) += monotime() - start;
+    }
+
+private:
+    enum { MaxDepths = 4, MaxGCs = 8, MaxEntries = 32 };
+    struct Pool {
+        unsigned depth;
+        int count;
+        GC gcs[MaxGCs];
+    };
+
+    Pool* pool(unsigned depth);
+    void clear(GraphicsEntry* entry);
+    void report();
+
+    Pool fPools[MaxDepths];
+    GraphicsEntry fEntries[MaxEntries];
+    int fCount;
+    unsigned fClock;
+    unsigned fGraphics;
+    unsigned long fSaved;
+    unsigned long fPrimitives;
+    unsigned long fBatches;
+    unsigned long fRendered;
+    unsigned long fReused;
+    timeval fRenderTime;
+    timeval fReuseTime;
+};
+
+static GraphicsCache graphicsCache;
+
+GraphicsCache::Pool* GraphicsCache::pool(unsigned depth) {
+    for (Pool& p : fPools) {
+        if (p.depth == depth)
+            return &p;
+        if (p.depth == 0) {
+            p.depth = depth;
+            return &p;
+        }
+    }
+    return nullptr;
+}
+
+GC GraphicsCache::acquire(Drawable drawable, unsigned depth,
+                          unsigned long mask, XGCValues* values)
+{
+    if (++fGraphics % 1000 == 0)
+        report();
+
+    Pool* p = pool(depth);
+    if (p == nullptr || p->count == 0)
+        return XCreateGC(display(), drawable, mask, values);
+
+    // restore what XCreateGC gives, and what Graphics may change
+    XGCValues gcv;
+    gcv.function = GXcopy;
+    gcv.foreground = 0;
+    gcv.background = 1;
+    gcv.line_width = 0;
+    gcv.line_style = LineSolid;
+    gcv.cap_style = CapButt;
+    gcv.join_style = JoinMiter;
+    gcv.fill_style = FillSolid;
+    gcv.ts_x_origin = gcv.ts_y_origin = 0;
+    gcv.subwindow_mode = ClipByChildren;
+    gcv.graphics_exposures = True;
+    gcv.clip_x_origin = gcv.clip_y_origin = 0;
+    gcv.clip_mask = None;
+    gcv.dash_offset = 0;
+    gcv.dashes = 4;
+    const unsigned long reset =
+        GCFunction | GCForeground | GCBackground | GCLineWidth |
+        GCLineStyle | GCCapStyle | GCJoinStyle | GCFillStyle |
+        GCTileStipXOrigin | GCTileStipYOrigin | GCSubwindowMode |
+        GCGraphicsExposures | GCClipXOrigin | GCClipYOrigin |
+        GCClipMask | GCDashOffset | GCDashList;
+
+    // Xlib sends only the values which differ, with the next request
+    GC gc = p->gcs[--p->count];
+    XChangeGC(display(), gc, reset, &gcv);
+    if (mask)
+        XChangeGC(display(), gc, mask, values);
+    saved();
+    return gc;
+}
+
+void GraphicsCache::release(GC gc, unsigned depth) {
+    Pool* p = pool(depth);
+    if (p && p->count < MaxGCs)
+        p->gcs[p->count++] = gc;
+    else
+        XFreeGC(display(), gc);
+}
+
+GraphicsEntry* GraphicsCache::attach(Drawable drawable, unsigned depth) {
+    GraphicsEntry* oldest = nullptr;
+    for (int i = 0; i < fCount; ++i) {
+        GraphicsEntry* e = &fEntries[i];
+        if (e->drawable == drawable && e->forgotten == false) {
+            e->users++;
+            e->used = ++fClock;
+            return e;
+        }
+        if (e->users == 0 && (oldest == nullptr || e->used < oldest->used))
+            oldest = e;
+    }
+
+    GraphicsEntry* e = nullptr;
+    if (fCount < MaxEntries) {
+        e = &fEntries[fCount++];
+    }
+    else if (oldest) {
+        e = oldest;
+        if (e->picture) {
+            XRenderFreePicture(display(), e->picture);
+            e->picture = None;
+        }
+#ifdef CONFIG_XFREETYPE
+        if (e->xft && e->depth != depth) {
+            XftDrawDestroy(e->xft);
+            e->xft = nullptr;
+        }
+        else if (e->xft) {
+            XftDrawChange(e->xft, drawable);
+        }
+#endif
+    }
+    else {
+        return nullptr;
+    }
+    e->drawable = drawable;
+    e->depth = depth;
+    e->users = 1;
+    e->drawing = false;
+    e->forgotten = false;
+    e->used = ++fClock;
+    return e;
+}
+
+void GraphicsCache::detach(GraphicsEntry* entry) {
+    if (--entry->users == 0 && entry->forgotten)
+        clear(entry);
+}
+
+void GraphicsCache::clear(GraphicsEntry* e) {
+    if (e->picture) {
+        XRenderFreePicture(display(), e->picture);
+        e->picture = None;
+    }
+#ifdef CONFIG_XFREETYPE
+    if (e->xft) {
+        XftDrawDestroy(e->xft);
+        e->xft = nullptr;
+    }
+#endif
+    e->drawable = None;
+    e->forgotten = false;
+    e->used = 0;
+}
+
+void GraphicsCache::forget(Drawable drawable) {
+    for (int i = 0; i < fCount; ++i) {
+        GraphicsEntry* e = &fEntries[i];
+        if (e->drawable == drawable && e->forgotten == false) {
+            if (e->users)
+                e->forgotten = true;
+            else
+                clear(e);
+        }
+    }
+}
+
+void GraphicsCache::report() {
+    if (YTrace::traces("paint")) {
+        int gcs = 0, cached = 0;
+        for (const Pool& p : fPools)
+            gcs += p.count;
+        for (int i = 0; i < fCount; ++i)
+            cached += (fEntries[i].drawable != None);
+        // what the reused images would have cost to render again
+        double render = toDouble(fRenderTime);
+        double reuse = toDouble(fReuseTime);
+        double saved = fRendered ? fReused * render / fRendered - reuse : 0;
+        tlog("paint: %u graphics, %lu requests saved, "
+             "%d GCs and %d pixmaps cached, "
+             "%lu primitives batched in %lu requests, "
+             "%lu images rendered in %.1f ms and %lu reused in %.1f ms, "
+             "%.1f ms saved",
+             fGraphics, fSaved, gcs, cached, fPrimitives, 2 * fBatches,
+             fRendered, 1e3 * render, fReused, 1e3 * reuse, 1e3 * saved);
+    }
+}
+
 Graphics::Graphics(YWindow & window,
                    unsigned long vmask, XGCValues * gcv):
     fDrawable(window.handle()),
+    fEntry(nullptr),
+    fCacheable(false),
     fColor(), fFont(),
     fPicture(None),
     xOrigin(0), yOrigin(0)
@@ -34,14 +269,17 @@ Graphics::Graphics(YWindow & window,
     rWidth = window.width();
     rHeight = window.height();
     rDepth = (window.depth() ? window.depth() : xapp->depth());
-    gc = XCreateGC(display(), drawable(), vmask, gcv);
+    gc = graphicsCache.acquire(drawable(), rDepth, vmask, gcv);
 #ifdef CONFIG_XFREETYPE
     fXftDraw = nullptr;
+    fXftClipped = false;
 #endif
 }
 
 Graphics::Graphics(YWindow & window):
     fDrawable(window.handle()),
+    fEntry(nullptr),
+    fCacheable(false),
     fColor(), fFont(),
     fPicture(None),
     xOrigin(0), yOrigin(0)
@@ -50,14 +288,17 @@ Graphics::Graphics(YWindow & window):
     rHeight = window.height();
     rDepth = (window.depth() ? window.depth() : xapp->depth());
     XGCValues gcv; gcv.graphics_exposures = False;
-    gc = XCreateGC(display(), drawable(), GCGraphicsExposures, &gcv);
+    gc = graphicsCache.acquire(drawable(), rDepth, GCGraphicsExposures, &gcv);
 #ifdef CONFIG_XFREETYPE
     fXftDraw = nullptr;
+    fXftClipped = false;
 #endif
 }
 
 Graphics::Graphics(ref<YPixmap> pixmap):
     fDrawable(pixmap->pixmap()),
+    fEntry(nullptr),
+    fCacheable(true),
     fColor(), fFont(),
     fPicture(None),
     xOrigin(0), yOrigin(0)
@@ -66,63 +307,104 @@ Graphics::Graphics(ref<YPixmap> pixmap):
     rHeight = pixmap->height();
     rDepth = pixmap->depth();
     XGCValues gcv; gcv.graphics_exposures = False;
-    gc = XCreateGC(display(), drawable(), GCGraphicsExposures, &gcv);
+    gc = graphicsCache.acquire(drawable(), rDepth, GCGraphicsExposures, &gcv);
 #ifdef CONFIG_XFREETYPE
     fXftDraw = nullptr;
+    fXftClipped = false;
 #endif
 }
 
 Graphics::Graphics(Drawable drawable, unsigned w, unsigned h, unsigned depth,
                    unsigned long vmask, XGCValues * gcv):
     fDrawable(drawable),
+    fEntry(nullptr),
+    fCacheable(true),
     fColor(), fFont(),
     fPicture(None),
     xOrigin(0), yOrigin(0),
     rWidth(w), rHeight(h), rDepth(depth)
 {
-    gc = XCreateGC(display(), drawable, vmask, gcv);
+    gc = graphicsCache.acquire(drawable, depth, vmask, gcv);
 #ifdef CONFIG_XFREETYPE
     fXftDraw = nullptr;
+    fXftClipped = false;
 #endif
 }
 
 Graphics::Graphics(Drawable drawable, unsigned w, unsigned h, unsigned depth):
     fDrawable(drawable),
+    fEntry(nullptr),
+    fCacheable(true),
     fColor(), fFont(),
     fPicture(None),
     xOrigin(0), yOrigin(0),
     rWidth(w), rHeight(h), rDepth(depth)
 {
     XGCValues gcv; gcv.graphics_exposures = False;
-    gc = XCreateGC(display(), drawable, GCGraphicsExposures, &gcv);
+    gc = graphicsCache.acquire(drawable, depth, GCGraphicsExposures, &gcv);
 #ifdef CONFIG_XFREETYPE
     fXftDraw = nullptr;
+    fXftClipped = false;
 #endif
 }
 
 Graphics::~Graphics() {
-    XFreeGC(display(), gc);
+    graphicsCache.release(gc, rDepth);
     gc = None;
 
     if (fPicture) {
-        XRenderFreePicture(display(), fPicture);
+        if (fEntry == nullptr || fEntry->picture != fPicture)
+            XRenderFreePicture(display(), fPicture);
         fPicture = None;
     }
 
 #ifdef CONFIG_XFREETYPE
     if (fXftDraw) {
-        XftDrawDestroy(fXftDraw);
+        if (fEntry == nullptr || fEntry->xft != fXftDraw)
+            XftDrawDestroy(fXftDraw);
+        else {
+            if (fXftClipped)
+                XftDrawSetClip(fXftDraw, nullptr);
+            fEntry->drawing = false;
+        }
         fXftDraw = nullptr;
     }
 #endif
+
+    if (fEntry) {
+        graphicsCache.detach(fEntry);
+        fEntry = nullptr;
+    }
+}
+
+void Graphics::forget(Drawable drawable) {
+    graphicsCache.forget(drawable);
+}
+
+void Graphics::attach() {
+    if (fEntry == nullptr && fCacheable && fDrawable)
+        fEntry = graphicsCache.attach(fDrawable, rDepth);
 }
 
 #ifdef CONFIG_XFREETYPE
 XftDraw* Graphics::handleXft() {
     if (fXftDraw == nullptr) {
-        fXftDraw = XftDrawCreate(display(), drawable(),
-                                 xapp->visualForDepth(rdepth()),
-                                 xapp->colormapForDepth(rdepth()));
+        attach();
+        // a nested Graphics on the same pixmap gets its own XftDraw
+        if (fEntry && fEntry->drawing == false) {
+            if (fEntry->xft)
+                graphicsCache.saved();
+            else
+                fEntry->xft = XftDrawCreate(display(), drawable(),
+                                            xapp->visualForDepth(rdepth()),
+                                            xapp->colormapForDepth(rdepth()));
+            fEntry->drawing = true;
+            fXftDraw = fEntry->xft;
+        } else {
+            fXftDraw = XftDrawCreate(display(), drawable(),
+                                     xapp->visualForDepth(rdepth()),
+                                     xapp->colormapForDepth(rdepth()));
+        }
     }
     return fXftDraw;
 }
@@ -130,14 +412,21 @@ XftDraw* Graphics::handleXft() {
 
 Picture Graphics::picture() {
     if (fPicture == None) {
+        attach();
+        if (fEntry && fEntry->picture) {
+            graphicsCache.saved();
+            fPicture = fEntry->picture;
+        }
         XRenderPictFormat* format = xapp->formatForDepth(rDepth);
-        if (format) {
+        if (fPicture == None && format) {
             XRenderPictureAttributes attr;
             unsigned long mask = None;
             attr.component_alpha = (rDepth == 32);
             mask |= CPComponentAlpha;
             fPicture = XRenderCreatePicture(display(), fDrawable,
                                             format, mask, &attr);
+            if (fEntry)
+                fEntry->picture = fPicture;
         }
     }
     return fPicture;
@@ -543,6 +832,86 @@ void Graphics::drawImage(ref<YImage> img, int x, int y) {
     drawImage(img, 0, 0, img->width(), img->height(), x, y);
 }
 
+// Images which were scaled and rendered to a pixmap, mostly gradients,
+// which are drawn again for every paint of the same window.
+// Entries hold on to their source image, so its address stays unique.
+class ImageCache {
+public:
+    ImageCache() : fSerial(0), fPixels(0) { }
+
+    ref<YPixmap> rendered(ref<YImage> image, unsigned width, unsigned height,
+                          unsigned depth, bool premult);
+    void clear() { fEntries.clear(); fPixels = 0; }
+
+private:
+    enum { MaxCached = 64, MaxPixels = 4 << 20 };
+    struct Entry {
+        ref<YImage> image;
+        ref<YPixmap> pixmap;
+        unsigned width, height, depth;
+        bool premult;
+        unsigned serial;
+    };
+    void discard(int index);
+
+    YObjectArray<Entry> fEntries;
+    unsigned fSerial;
+    unsigned long fPixels;
+};
+
+static ImageCache imageCache;
+
+ref<YPixmap> ImageCache::rendered(ref<YImage> image,
+                                  unsigned width, unsigned height,
+                                  unsigned depth, bool premult)
+{
+    const timeval start = monotime();
+    for (Entry* e : fEntries) {
+        if (e->image == image && e->width == width && e->height == height &&
+            e->depth == depth && e->premult == premult)
+        {
+            e->serial = ++fSerial;
+            graphicsCache.rendered(true, start);
+            return e->pixmap;
+        }
+    }
+
+    ref<YImage> scaled(image);
+    if (width != image->width() || height != image->height())
+        scaled = image->scale(width, height);
+    ref<YPixmap> pixmap;
+    if (scaled != null)
+        pixmap = scaled->renderToPixmap(depth, premult);
+    graphicsCache.rendered(false, start);
+
+    const unsigned long pixels = (unsigned long) width * height;
+    if (pixmap != null && pixels <= MaxPixels / 4) {
+        while (fEntries.getCount() >= MaxCached ||
+               fPixels + pixels > MaxPixels)
+        {
+            int oldest = 0;
+            for (int i = 1; i < fEntries.getCount(); ++i)
+                if (fEntries[i]->serial < fEntries[oldest]->serial)
+                    oldest = i;
+            discard(oldest);
+        }
+        fEntries += new Entry{ image, pixmap, width, height, depth,
+                               premult, ++fSerial };
+        fPixels += pixels;
+    }
+    return pixmap;
+}
+
+void ImageCache::discard(int index) {
+    fPixels -= (unsigned long) fEntries[index]->width
+             * fEntries[index]->height;
+    fEntries.remove(index);
+}
+
+void Graphics::clearImages() {
+    imageCache.clear();
+}
+
 void Graphics::drawImage(ref<YImage> img, int x, int y, unsigned w, unsigned h, int dx, int dy) {
     if (picture()) {
         unsigned depth = max(img->depth(), rdepth());
@@ -567,6 +936,43 @@ void Graphics::drawImage(ref<YImage> img, int x, int y, unsigned w, unsigned h,
     }
 }
 
+void Graphics::drawCached(ref<YImage> img, int x, int y, unsigned w, unsigned h, int dx, int dy) {
+    drawScaled(img, img->width(), img->height(), x, y, w, h, dx, dy);
+}
+
+// draw part of an image scaled to sw by sh, by a pixmap from the cache
+void Graphics::drawScaled(ref<YImage> img, unsigned sw, unsigned sh,
+                          int x, int y, unsigned w, unsigned h,
+                          int dx, int dy)
+{
+    if (picture()) {
+        unsigned depth = max(img->depth(), rdepth());
+        ref<YPixmap> pix(imageCache.rendered(img, sw, sh, depth,
+                                             img->depth() == 32));
+        if (pix != null) {
+            Picture source = pix->picture();
+            XRenderComposite(display(),
+                             img->hasAlpha() ? PictOpOver : PictOpSrc,
+                             source, None, picture(),
+                             x, y, 0, 0, dx, dy, w, h);
+            return;
+        }
+    }
+    if (img->hasAlpha() == false || img->supportsDepth(rdepth()) == false) {
+        ref<YPixmap> pix(imageCache.rendered(img, sw, sh, rdepth(), false));
+        if (pix != null) {
+            drawPixmap(pix, x, y, w, h, dx, dy);
+        }
+    }
+    else {
+        ref<YImage> scaled(img);
+        if (sw != img->width() || sh != img->height())
+            scaled = img->scale(sw, sh);
+        if (scaled != null)
+            scaled->draw(*this, x, y, w, h, dx, dy);
+    }
+}
+
 void Graphics::drawPixmap(ref<YPixmap> pix, int x, int y) {
     drawPixmap(pix, 0, 0, pix->width(), pix->height(), x, y);
 }
@@ -975,17 +1381,13 @@ void Graphics::drawGradient(ref<YImage> gradient,
                             int x, int y, unsigned w, unsigned h,
                             int gx, int gy, unsigned gw, unsigned gh)
 {
-    ref<YImage> scaled = gradient->scale(gw, gh);
-    if (scaled != null)
-        scaled->draw(*this, gx, gy, w, h, x, y);
+    drawScaled(gradient, gw, gh, gx, gy, w, h, x, y);
 }
 
 void Graphics::drawGradient(ref<YImage> gradient,
                             int x, int y, unsigned w, unsigned h)
 {
-    ref<YImage> scaled = gradient->scale(w, h);
-    if (scaled != null)
-        scaled->draw(*this, 0, 0, w, h, x, y);
+    drawScaled(gradient, w, h, 0, 0, w, h, x, y);
 }
 
 /******************************************************************************/
@@ -1119,6 +1521,7 @@ void Graphics::setClipRectangles(XRectangle *rect, int count) {
                        -xOrigin, -yOrigin, rect, count, Unsorted);
 #ifdef CONFIG_XFREETYPE
     XftDrawSetClipRectangles(handleXft(), -xOrigin, -yOrigin, rect, count);
+    fXftClipped = true;
 #endif
 }
 
@@ -1130,6 +1533,7 @@ void Graphics::resetClip() {
     XSetClipMask(display(), gc, None);
 #ifdef CONFIG_XFREETYPE
     XftDrawSetClip(handleXft(), nullptr);
+    fXftClipped = false;
 #endif
 }
 
@@ -1144,6 +1548,194 @@ void Graphics::maxOpacity() {
 
 /******************************************************************************/
 
+GraphicsBatch::~GraphicsBatch() {
+    flush();
+}
+
+GraphicsBatch::Batch* GraphicsBatch::batch(const YColor& color) {
+    YColor c(color);
+    for (Batch* b : fBatches)
+        if (b->pixel == c.pixel())
+            return b;
+    Batch* b = new Batch;
+    b->color = color;
+    b->pixel = c.pixel();
+    fBatches += b;
+    return b;
+}
+
+void GraphicsBatch::drawLine(const YColor& color,
+                             int x1, int y1, int x2, int y2)
+{
+    if (color) {
+        XSegment s = { short(x1), short(y1), short(x2), short(y2) };
+        batch(color)->segments += s;
+    }
+}
+
+void GraphicsBatch::fillRect(const YColor& color,
+                             int x, int y, unsigned w, unsigned h)
+{
+    if (color && w && h) {
+        XRectangle r = { short(x), short(y),
+                         (unsigned short) w, (unsigned short) h };
+        batch(color)->rects += r;
+    }
+}
+
+void GraphicsBatch::flush() {
+    unsigned primitives = 0, requests = 0;
+    for (Batch* b : fBatches) {
+        fGraphics.setColor(b->color);
+        if (b->segments.nonempty()) {
+            fGraphics.drawSegments(&b->segments[0], b->segments.getCount());
+            primitives += b->segments.getCount();
+            requests += 1;
+        }
+        if (b->rects.nonempty()) {
+            fGraphics.fillRects(&b->rects[0], b->rects.getCount());
+            primitives += b->rects.getCount();
+            requests += 1;
+        }
+    }
+    if (primitives)
+        graphicsCache.batched(primitives, requests);
+    fBatches.clear();
+}
+
+/******************************************************************************/
+
+// Back buffers come from a pool of pixmaps with sizes rounded up to
+// buckets, so an interactive resize reuses a few of them instead of
+// creating one per motion event. A pixmap may still be the background
+// of the window which last painted it, so only that window reuses it,
+// until it gets another background. Idle pixmaps are freed after
+// a second without any release.
+class PixmapPool : public YTimerListener {
+public:
+    PixmapPool() : fSerial(0), fHits(0), fMisses(0) { }
+
+    Pixmap acquire(Window window, YDimension size, unsigned depth);
+    void release(Pixmap pixmap);
+    void background(Window window, Pixmap pixmap);
+    void clear();
+    virtual bool handleTimer(YTimer* timer);
+
+    static unsigned bucket(unsigned n) {
+        // round up by a quarter of the magnitude at most
+        unsigned step = 16;
+        while (step * 8 <= n)
+            step <<= 1;
+        return (n + step - 1) & ~(step - 1);
+    }
+    static YDimension bucket(YDimension size) {
+        return YDimension(bucket(size.w), bucket(size.h));
+    }
+
+private:
+    enum { MaxPooled = 32 };
+    struct Entry {
+        Pixmap pixmap;
+        unsigned width, height, depth;
+        Window owner;
+        unsigned serial;
+        bool busy;
+    };
+    void discard(int index);
+
+    YArray<Entry> fEntries;
+    lazy<YTimer> fTimer;
+    unsigned fSerial;
+    unsigned fHits;
+    unsigned fMisses;
+};
+
+static PixmapPool pixmapPool;
+
+Pixmap PixmapPool::acquire(Window window, YDimension size, unsigned depth) {
+    int found = -1;
+    for (int i = 0; i < fEntries.getCount(); ++i) {
+        const Entry& e = fEntries[i];
+        if (e.busy == false && e.width == size.w && e.height == size.h &&
+            e.depth == depth && (e.owner == window || e.owner == None))
+        {
+            found = i;
+            if (e.owner == window)
+                break;
+        }
+    }
+    if (0 <= found) {
+        fEntries[found].busy = true;
+        fHits++;
+        return fEntries[found].pixmap;
+    }
+
+    fMisses++;
+    if (fEntries.getCount() >= MaxPooled) {
+        int oldest = -1;
+        for (int i = 0; i < fEntries.getCount(); ++i)
+            if (fEntries[i].busy == false &&
+                (oldest < 0 || fEntries[i].serial < fEntries[oldest].serial))
+                oldest = i;
+        if (0 <= oldest)
+            discard(oldest);
+    }
+    Entry e = { XCreatePixmap(display(), xapp->root(), size.w, size.h, depth),
+                size.w, size.h, depth, None, ++fSerial, true, };
+    fEntries += e;
+    return e.pixmap;
+}
+
+void PixmapPool::release(Pixmap pixmap) {
+    for (Entry& e : fEntries) {
+        if (e.pixmap == pixmap) {
+            e.busy = false;
+            e.serial = ++fSerial;
+            fTimer->setTimer(1000L, this, true);
+            break;
+        }
+    }
+}
+
+void PixmapPool::background(Window window, Pixmap pixmap) {
+    for (Entry& e : fEntries) {
+        if (e.pixmap == pixmap)
+            e.owner = window;
+        else if (e.owner == window)
+            e.owner = None;
+    }
+}
+
+void PixmapPool::clear() {
+    fTimer = null;
+    for (int i = fEntries.getCount(); 0 <= --i; )
+        discard(i);
+}
+
+void GraphicsBuffer::clearPool() {
+    pixmapPool.clear();
+}
+
+void PixmapPool::discard(int index) {
+    Graphics::forget(fEntries[index].pixmap);
+    XFreePixmap(display(), fEntries[index].pixmap);
+    fEntries.remove(index);
+}
+
+bool PixmapPool::handleTimer(YTimer* timer) {
+    int trimmed = 0;
+    for (int i = fEntries.getCount(); 0 <= --i; ) {
+        if (fEntries[i].busy == false) {
+            discard(i);
+            trimmed++;
+        }
+    }
+    MSG(("pixmap pool: %u hits, %u misses, %d%% hit rate, %d trimmed",
+         fHits, fMisses, fHits ? int(100ULL * fHits / (fHits + fMisses)) : 0,
+         trimmed));
+    return false;
+}
+
 void GraphicsBuffer::paint(Pixmap pixmap, const YRect& rect) {
     if (window()->handle() && window()->destroyed())
         return;
@@ -1181,6 +1773,7 @@ void GraphicsBuffer::paint(Pixmap pixmap, const YRect& rect) {
     if (fNesting == 1) {
         if (pixmap == fPixmap && !window()->destroyed()) {
             window()->setBackgroundPixmap(pixmap);
+            pixmapPool.background(window()->handle(), pixmap);
             window()->clearArea(x, y, w, h);
         }
         if (clipping) {
@@ -1193,7 +1786,7 @@ void GraphicsBuffer::paint(Pixmap pixmap, const YRect& rect) {
 
 void GraphicsBuffer::release() {
     if (fPixmap) {
-        XFreePixmap(display(), fPixmap);
+        pixmapPool.release(fPixmap);
         fPixmap = None;
     }
 }
@@ -1214,11 +1807,15 @@ void GraphicsBuffer::paint() {
 }
 
 Pixmap GraphicsBuffer::pixmap() {
-    if (fPixmap == None || fDim != window()->dimension()) {
-        if (fPixmap) XFreePixmap(display(), fPixmap);
-        fPixmap = window()->createPixmap();
-        fDim = window()->dimension();
+    YDimension dim(window()->dimension());
+    YDimension size(PixmapPool::bucket(dim));
+    if (fPixmap == None || fBucket != size) {
+        release();
+        fPixmap = pixmapPool.acquire(window()->handle(), size,
+                                     window()->depth());
+        fBucket = size;
     }
+    fDim = dim;
     return fPixmap;
 }
 
@@ -14,6 +14,7 @@
 
 #include "ycolor.h"
 #include "yfontbase.h"
+#include "yarray.h"
 
 class mstring;
 class YWindow;
@@ -134,6 +135,9 @@ public:
     void drawPixmap(ref<YPixmap> pix, int x, int y, unsigned w, unsigned h, int dx, int dy);
     void drawImage(ref<YImage> pix, int x, int y);
     void drawImage(ref<YImage> pix, int x, int y, unsigned w, unsigned h, int dx, int dy);
+    // like drawImage, but keep the rendered pixmap for the next paint,
+    // for gradients and other images which are drawn over and over
+    void drawCached(ref<YImage> img, int x, int y, unsigned w, unsigned h, int dx, int dy);
     void compositeImage(ref<YImage> pix, int x, int y, unsigned w, unsigned h, int dx, int dy);
     void drawMask(ref<YPixmap> pix, int x, int y);
     void drawClippedPixmap(Pixmap pix, Pixmap clip,
@@ -199,12 +203,20 @@ public:
     void resetClip();
     void maxOpacity();
 
+    // release cached resources for a pixmap before it is freed
+    static void forget(Drawable drawable);
+    // release the pixmaps of scaled images and gradients
+    static void clearImages();
+
 private:
     Drawable fDrawable;
     GC gc;
 #ifdef CONFIG_XFREETYPE
     struct _XftDraw* fXftDraw;
+    bool fXftClipped;
 #endif
+    struct GraphicsEntry* fEntry;
+    bool fCacheable;
 
     YColor   fColor;
     YFont fFont;
@@ -212,10 +224,41 @@ private:
     int xOrigin, yOrigin;
     unsigned rWidth, rHeight, rDepth;
 
+    void attach();
+    void drawScaled(ref<YImage> img, unsigned sw, unsigned sh,
+                    int x, int y, unsigned w, unsigned h, int dx, int dy);
+
     Graphics(Graphics const&) = delete;
     Graphics& operator=(Graphics const&) = delete;
 };
 
+// Collect lines and rectangles per color and send each color
+// as one XDrawSegments and one XFillRectangles on flush.
+class GraphicsBatch {
+public:
+    explicit GraphicsBatch(Graphics& g) : fGraphics(g) { }
+    ~GraphicsBatch();
+
+    void drawLine(const YColor& color, int x1, int y1, int x2, int y2);
+    void fillRect(const YColor& color, int x, int y, unsigned w, unsigned h);
+    void flush();
+
+private:
+    struct Batch {
+        YColor color;
+        unsigned long pixel;
+        YArray<XSegment> segments;
+        YArray<XRectangle> rects;
+    };
+    Batch* batch(const YColor& color);
+
+    Graphics& fGraphics;
+    YObjectArray<Batch> fBatches;
+
+    GraphicsBatch(const GraphicsBatch&) = delete;
+    GraphicsBatch& operator=(const GraphicsBatch&) = delete;
+};
+
 /******************************************************************************/
 /******************************************************************************/
 
@@ -226,7 +269,8 @@ public:
         fClipping(clipping),
         fNesting(0),
         fPixmap(None),
-        fDim(0, 0)
+        fDim(0, 0),
+        fBucket(0, 0)
     {
     }
     ~GraphicsBuffer();
@@ -234,6 +278,8 @@ public:
     void paint();
     void release();
     void scroll(int dx, int dy);
+    // free the pool of back buffers before the display closes
+    static void clearPool();
 
     YWindow* window() const { return fWindow; }
     int nesting() const { return fNesting; }
@@ -244,7 +290,8 @@ private:
     bool fClipping;
     int fNesting;
     Pixmap fPixmap;
-    YDimension fDim;
+    YDimension fDim;        // the window size which was painted
+    YDimension fBucket;     // the size of the pooled pixmap
 
     Pixmap pixmap();
     void paint(Pixmap p, const class YRect& rect);
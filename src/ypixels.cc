@@ -0,0 +1,130 @@
+/*
+ *  IceWM - Bulk pixel conversions of XImages
+ *
+ *  Release under terms of the GNU Library General Public License
+ */
+
+#include "config.h"
+#include "ypixels.h"
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+bool pixelsUseSSE2 = true;
+
+bool nativePixels(const XImage* image) {
+    const unsigned one = 1;
+    const int order = *(const char *) &one ? LSBFirst : MSBFirst;
+    return image->format == ZPixmap && image->bits_per_pixel == 32
+        && image->byte_order == order;
+}
+
+bool translucentPixels(const XImage* image) {
+    for (int j = 0; j < image->height; j++) {
+        const uint32_t* row = pixelRow(image, j);
+        int i = 0;
+#ifdef __SSE2__
+        for (; pixelsUseSSE2 && i + 4 <= image->width; i += 4) {
+            __m128i p = _mm_loadu_si128((const __m128i *) (row + i));
+            if (_mm_movemask_ps(_mm_castsi128_ps(p)) != 0xF)
+                return true;
+        }
+#endif
+        for (; i < image->width; i++)
+            if (row[i] < 0x80000000U)
+                return true;
+    }
+    return false;
+}
+
+// XGetPixel drops the bits above the depth, XPutPixel keeps all
+bool copyPixels(const XImage* source, XImage* target) {
+    const bool packed = (target->format == ZPixmap &&
+                         target->bits_per_pixel == 24);
+    if (packed == false && nativePixels(target) == false)
+        return false;
+
+    const uint32_t keep = source->depth < 32
+                        ? (1U << source->depth) - 1 : 0xFFFFFFFFU;
+    for (int j = 0; j < source->height; j++) {
+        const uint32_t* row = pixelRow(source, j);
+        char* line = target->data + j * target->bytes_per_line;
+        if (packed) {
+            // three bytes per pixel, which SSE2 can't shuffle well
+            unsigned char* out = (unsigned char *) line;
+            const bool msb = (target->byte_order == MSBFirst);
+            for (int i = 0; i < source->width; i++, out += 3) {
+                const uint32_t p = row[i] & keep;
+                out[msb ? 2 : 0] = (unsigned char) p;
+                out[1] = (unsigned char) (p >> 8);
+                out[msb ? 0 : 2] = (unsigned char) (p >> 16);
+            }
+            continue;
+        }
+        uint32_t* out = (uint32_t *) line;
+        if (keep == 0xFFFFFFFFU) {
+            memcpy(out, row, source->width * sizeof(uint32_t));
+            continue;
+        }
+        int i = 0;
+#ifdef __SSE2__
+        const __m128i mask = _mm_set1_epi32(int(keep));
+        for (; pixelsUseSSE2 && i + 4 <= source->width; i += 4) {
+            __m128i p = _mm_loadu_si128((const __m128i *) (row + i));
+            _mm_storeu_si128((__m128i *) (out + i), _mm_and_si128(p, mask));
+        }
+#endif
+        for (; i < source->width; i++)
+            out[i] = row[i] & keep;
+    }
+    return true;
+}
+
+#ifdef __SSE2__
+static unsigned char reverseBits(unsigned char b) {
+    b = (unsigned char) ((b & 0xF0) >> 4 | (b & 0x0F) << 4);
+    b = (unsigned char) ((b & 0xCC) >> 2 | (b & 0x33) << 2);
+    b = (unsigned char) ((b & 0xAA) >> 1 | (b & 0x55) << 1);
+    return b;
+}
+#endif
+
+void thresholdMask(const XImage* source, XImage* mask, bool masked,
+                   unsigned threshold)
+{
+    const bool msb = (mask->bitmap_bit_order == MSBFirst);
+    for (int j = 0; j < source->height; j++) {
+        const uint32_t* row = pixelRow(source, j);
+        unsigned char* out = (unsigned char *)
+                             (mask->data + j * mask->bytes_per_line);
+        int i = 0;
+#ifdef __SSE2__
+        const __m128i ath = _mm_set1_epi8(char(threshold));
+        for (; pixelsUseSSE2 && i + 16 <= source->width; i += 16) {
+            unsigned bits = 0xFFFF;
+            if (masked) {
+                const __m128i* p = (const __m128i *) (row + i);
+                __m128i a0 = _mm_srli_epi32(_mm_loadu_si128(p + 0), 24);
+                __m128i a1 = _mm_srli_epi32(_mm_loadu_si128(p + 1), 24);
+                __m128i a2 = _mm_srli_epi32(_mm_loadu_si128(p + 2), 24);
+                __m128i a3 = _mm_srli_epi32(_mm_loadu_si128(p + 3), 24);
+                __m128i a = _mm_packus_epi16(_mm_packs_epi32(a0, a1),
+                                             _mm_packs_epi32(a2, a3));
+                __m128i ge = _mm_cmpeq_epi8(_mm_max_epu8(a, ath), a);
+                bits = unsigned(_mm_movemask_epi8(ge));
+            }
+            unsigned char lo = (unsigned char) bits;
+            unsigned char hi = (unsigned char) (bits >> 8);
+            out[i >> 3] = msb ? reverseBits(lo) : lo;
+            out[(i >> 3) + 1] = msb ? reverseBits(hi) : hi;
+        }
+#endif
+        for (; i < source->width; i++) {
+            if (!masked || (row[i] >> 24) >= threshold)
+                out[i >> 3] |= msb ? 0x80 >> (i & 7) : 1 << (i & 7);
+        }
+    }
+}
+
+// vim: set sw=4 ts=4 et:
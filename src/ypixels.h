@@ -0,0 +1,35 @@
+#ifndef YPIXELS_H
+#define YPIXELS_H
+
+#include <stdint.h>
+#include <X11/Xlib.h>
+
+// Bulk conversions of XImages with 32 bits per pixel in host byte order,
+// as they are used by YXImage. The kernels have an SSE2 loop and a scalar
+// tail. Clearing pixelsUseSSE2 runs only the scalar code, for tests.
+extern bool pixelsUseSSE2;
+
+// whether the image has 32 bits per pixel in host byte order
+bool nativePixels(const XImage* image);
+
+inline const uint32_t* pixelRow(const XImage* image, int row) {
+    return (const uint32_t *) (image->data + row * image->bytes_per_line);
+}
+
+// whether any pixel of a native image is less than half opaque
+bool translucentPixels(const XImage* image);
+
+// copy a native image like XPutPixel of XGetPixel for every pixel,
+// to a native target or one with 24 bits per pixel in either byte order.
+// Return false for other targets.
+bool copyPixels(const XImage* source, XImage* target);
+
+// set a mask bit for every pixel with an alpha of at least threshold,
+// or for all pixels if not masked, in a zeroed bitmap whose bit order
+// is its byte order.
+void thresholdMask(const XImage* source, XImage* mask, bool masked,
+                   unsigned threshold);
+
+#endif
+
+// vim: set sw=4 ts=4 et:
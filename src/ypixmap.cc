@@ -36,10 +36,14 @@ void YPixmap::replicate(bool horiz, bool copyMask) {
             Graphics(nMask, width(), dim, depth()).repVert(fMask, width(), height(), 0, 0, dim);
     }
 
-    if (fPixmap != None)
+    if (fPixmap != None) {
+        Graphics::forget(fPixmap);
         XFreePixmap(xapp->display(), fPixmap);
-    if (fMask != None)
+    }
+    if (fMask != None) {
+        Graphics::forget(fMask);
         XFreePixmap(xapp->display(), fMask);
+    }
     if (fPixmap32 != null)
         fPixmap32 = null;
     if (fPixmap24 != null)
@@ -66,13 +70,17 @@ YPixmap::YPixmap(Pixmap pixmap, Pixmap mask,
 
 YPixmap::~YPixmap() {
     if (fPixmap != None) {
-        if (xapp != nullptr)
+        if (xapp != nullptr) {
+            Graphics::forget(fPixmap);
             XFreePixmap(xapp->display(), fPixmap);
+        }
         fPixmap = 0;
     }
     if (fMask != None) {
-        if (xapp != nullptr)
+        if (xapp != nullptr) {
+            Graphics::forget(fMask);
             XFreePixmap(xapp->display(), fMask);
+        }
         fMask = 0;
     }
     freePicture();
@@ -17,11 +17,17 @@ XIV(bool, multiByte,                            true)
 #endif
 XIV(bool, modSuperIsCtrlAlt,                    false)
 XIV(bool, doubleBuffer,                         true)
+XIV(bool, compressMotionEvents,                 true)
+XIV(bool, compressPropertyEvents,               true)
+XIV(bool, compressConfigureRequests,            true)
+XIV(bool, compressExposeEvents,                 true)
 XIV(bool, xrrDisable,                           false)
 XIV(int, xineramaPrimaryScreen,                 0)
 XIV(int, MenuActivateDelay,                     40)
 XIV(int, SubmenuActivateDelay,                  300)
 extern int DelayFuzziness;
+extern int SamplingTick;
+XIV(int, SlowDispatchThreshold,                 0)
 XIV(int, ClickMotionDistance,                   4)
 XIV(int, ClickMotionDelay,                      200)
 XIV(int, MultiClickTime,                        400)
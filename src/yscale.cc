@@ -0,0 +1,176 @@
+/*
+ *  IceWM - Box filter image scaling
+ *
+ *  Release under terms of the GNU Library General Public License
+ */
+
+#include "config.h"
+#include "yscale.h"
+#include "ypointer.h"
+#include "base.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Weights have 12 fraction bits and sum to exactly one per target pixel.
+// Horizontal sums are kept with 7 fraction bits, so that both passes
+// multiply two 16-bit quantities into one 32-bit lane.
+enum {
+    WeightBits = 12,
+    WeightOne = 1 << WeightBits,
+    RowBits = 7,
+    RowShift = WeightBits - RowBits,
+    FinalShift = WeightBits + RowBits,
+};
+
+// The source pixels and weights which make up each target pixel
+// along one dimension.
+class BoxSpans {
+public:
+    BoxSpans(unsigned size, unsigned newSize);
+
+    unsigned first(unsigned k) const { return fFirst[k]; }
+    unsigned count(unsigned k) const { return fOffset[k+1] - fOffset[k]; }
+    const int* weights(unsigned k) const { return &fWeight[fOffset[k]]; }
+
+private:
+    asmart<unsigned> fFirst;
+    asmart<unsigned> fOffset;
+    asmart<int> fWeight;
+};
+
+BoxSpans::BoxSpans(unsigned size, unsigned newSize) :
+    fFirst(new unsigned[newSize]),
+    fOffset(new unsigned[newSize + 1]),
+    fWeight(new int[size + 2 * newSize])
+{
+    // Source pixel i covers [i * newSize, (i + 1) * newSize) and
+    // target pixel k covers [k * size, (k + 1) * size). Weights are
+    // differences of the rounded cumulative coverage, which makes them
+    // sum to one without any weight becoming negative.
+    unsigned n = 0;
+    for (unsigned k = 0; k < newSize; ++k) {
+        const uint64_t lo = uint64_t(k) * size, hi = lo + size;
+        fFirst[k] = unsigned(lo / newSize);
+        fOffset[k] = n;
+        unsigned done = 0;
+        for (uint64_t i = lo / newSize; i * newSize < hi; ++i) {
+            uint64_t right = min(hi, (i + 1) * newSize) - lo;
+            unsigned cover = unsigned((right * WeightOne + size / 2) / size);
+            fWeight[n++] = int(cover - done);
+            done = cover;
+        }
+    }
+    fOffset[newSize] = n;
+}
+
+// Filter one source row horizontally into four lanes per target pixel.
+static void boxRow(const uint32_t* row, const BoxSpans& spans,
+                   unsigned newWidth, uint32_t* out)
+{
+    for (unsigned k = 0; k < newWidth; ++k, out += 4) {
+        const uint32_t* pixel = row + spans.first(k);
+        const int* weight = spans.weights(k);
+        const unsigned count = spans.count(k);
+#ifdef __SSE2__
+        const __m128i zero = _mm_setzero_si128();
+        __m128i sum = zero;
+        for (unsigned i = 0; i < count; ++i) {
+            __m128i p = _mm_cvtsi32_si128(int(pixel[i]));
+            p = _mm_unpacklo_epi16(_mm_unpacklo_epi8(p, zero), zero);
+            p = _mm_madd_epi16(p, _mm_set1_epi32(weight[i]));
+            sum = _mm_add_epi32(sum, p);
+        }
+        sum = _mm_add_epi32(sum, _mm_set1_epi32(1 << (RowShift - 1)));
+        _mm_storeu_si128((__m128i *) out, _mm_srli_epi32(sum, RowShift));
+#else
+        uint32_t sum[4] = { 0, 0, 0, 0 };
+        for (unsigned i = 0; i < count; ++i) {
+            for (int c = 0; c < 4; ++c)
+                sum[c] += ((pixel[i] >> (8 * c)) & 0xFF) * weight[i];
+        }
+        for (int c = 0; c < 4; ++c)
+            out[c] = (sum[c] + (1 << (RowShift - 1))) >> RowShift;
+#endif
+    }
+}
+
+// Blend a horizontally filtered row into the column sums.
+static void boxBlend(const uint32_t* row, int weight,
+                     unsigned newWidth, uint32_t* sums)
+{
+#ifdef __SSE2__
+    const __m128i factor = _mm_set1_epi32(weight);
+    for (unsigned k = 0; k < newWidth; ++k, row += 4, sums += 4) {
+        __m128i p = _mm_loadu_si128((const __m128i *) row);
+        __m128i s = _mm_loadu_si128((const __m128i *) sums);
+        s = _mm_add_epi32(s, _mm_madd_epi16(p, factor));
+        _mm_storeu_si128((__m128i *) sums, s);
+    }
+#else
+    for (unsigned n = 0; n < 4 * newWidth; ++n)
+        sums[n] += row[n] * weight;
+#endif
+}
+
+// Round the column sums to target pixels.
+static void boxFinish(const uint32_t* sums, unsigned newWidth,
+                      uint32_t* target)
+{
+#ifdef __SSE2__
+    const __m128i half = _mm_set1_epi32(1 << (FinalShift - 1));
+    for (unsigned k = 0; k < newWidth; ++k, sums += 4) {
+        __m128i s = _mm_loadu_si128((const __m128i *) sums);
+        s = _mm_srli_epi32(_mm_add_epi32(s, half), FinalShift);
+        s = _mm_packs_epi32(s, s);
+        target[k] = uint32_t(_mm_cvtsi128_si32(_mm_packus_epi16(s, s)));
+    }
+#else
+    for (unsigned k = 0; k < newWidth; ++k, sums += 4) {
+        uint32_t pixel = 0;
+        for (int c = 0; c < 4; ++c)
+            pixel |= ((sums[c] + (1 << (FinalShift - 1))) >> FinalShift)
+                     << (8 * c);
+        target[k] = pixel;
+    }
+#endif
+}
+
+void boxScale(const uint32_t* source, unsigned width, unsigned height,
+              unsigned stride, uint32_t* target, unsigned newWidth,
+              unsigned newHeight, unsigned newStride)
+{
+    if (width == 0 || height == 0 || newWidth == 0 || newHeight == 0)
+        return;
+
+    const BoxSpans columns(width, newWidth);
+    const BoxSpans rows(height, newHeight);
+    const unsigned lanes = 4 * newWidth;
+    asmart<uint32_t> sums(new uint32_t[lanes]);
+
+    // Consecutive target rows share at most two source rows,
+    // so keep the two most recently filtered source rows.
+    asmart<uint32_t> filtered(new uint32_t[2 * lanes]);
+    long cached[2] = { -1L, -1L };
+
+    for (unsigned l = 0; l < newHeight; ++l) {
+        for (unsigned n = 0; n < lanes; ++n)
+            sums[n] = 0;
+        const unsigned first = rows.first(l);
+        const int* weight = rows.weights(l);
+        for (unsigned j = 0; j < rows.count(l); ++j) {
+            const long index = long(first + j);
+            int slot = (cached[0] == index) ? 0 : (cached[1] == index) ? 1 : -1;
+            if (slot < 0) {
+                slot = (cached[0] < cached[1]) ? 0 : 1;
+                boxRow(source + size_t(index) * stride, columns, newWidth,
+                       &filtered[slot * lanes]);
+                cached[slot] = index;
+            }
+            boxBlend(&filtered[slot * lanes], weight[j], newWidth, sums);
+        }
+        boxFinish(sums, newWidth, target + size_t(l) * newStride);
+    }
+}
+
+// vim: set sw=4 ts=4 et:
@@ -0,0 +1,18 @@
+#ifndef YSCALE_H
+#define YSCALE_H
+
+#include <stdint.h>
+
+// Scale packed 32-bit ARGB pixels with an area weighted box filter.
+// Every target pixel is the average of the source area which it covers,
+// which serves both for shrinking and for enlarging an image.
+// The four channels are averaged independently, without premultiplying.
+// Strides are in pixels. Horizontal and vertical passes are separate:
+// each source row is filtered horizontally once, then rows are blended.
+void boxScale(const uint32_t* source, unsigned width, unsigned height,
+              unsigned stride, uint32_t* target, unsigned newWidth,
+              unsigned newHeight, unsigned newStride);
+
+#endif
+
+// vim: set sw=4 ts=4 et:
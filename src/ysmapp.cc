@@ -230,11 +230,11 @@ YXApplication(argc, argv, displayName)
 
 YSMApplication::~YSMApplication() {
     if (SMconn != nullptr) {
+        psm.unregisterPoll();
         SmcCloseConnection(SMconn, 0, nullptr);
         SMconn = nullptr;
         IceSMconn = nullptr;
         IceSMfd = -1;
-        unregisterPoll(&psm);
     }
 }
 
@@ -243,10 +243,10 @@ void YSMPoll::notifyRead() {
     if (IceProcessMessages(IceSMconn, nullptr, &rep)
         == IceProcessMessagesIOError)
     {
+        unregisterPoll();
         SmcCloseConnection(SMconn, 0, nullptr);
         IceSMconn = nullptr;
         IceSMfd = -1;
-        unregisterPoll();
     }
 }
 
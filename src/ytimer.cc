@@ -14,7 +14,10 @@ YTimer::YTimer(long ms) :
     fInterval(0L),
     fFuzziness(0L),
     fRunning(false),
-    fFixed(false)
+    fFixed(false),
+    fAligned(false),
+    fHeapIndex{-1, -1},
+    fPass(0)
 {
     setInterval(ms);
 }
@@ -25,7 +28,10 @@ YTimer::YTimer(long ms, YTimerListener* listener, bool start, bool fixed) :
     fInterval(max(0L, ms)),
     fFuzziness(0L),
     fRunning(false),
-    fFixed(fixed)
+    fFixed(fixed),
+    fAligned(false),
+    fHeapIndex{-1, -1},
+    fPass(0)
 {
     if (start)
         startTimer();
@@ -41,6 +47,13 @@ void YTimer::setFixed() {
     fFuzziness = 0L;
 }
 
+void YTimer::setAligned() {
+    // Aligned here means: expire on the shared sampling tick,
+    // such that all periodic samplers are handled in one wakeup.
+    fAligned = true;
+    fFuzziness = 0L;
+}
+
 bool YTimer::isFixed() const {
     return fFixed || !fFuzziness;
 }
@@ -61,11 +74,37 @@ void YTimer::startTimer(long ms) {
 void YTimer::startTimer() {
     fTimeout = monotime() + millitime(fInterval);
     fuzzTimer();
+    alignTimer();
     enlist();
 }
 
+void YTimer::alignTimer() {
+    if (fAligned && inrange(SamplingTick, 1, 60000)) {
+        // round to the nearest tick, which is in phase with the wall clock
+        const long long tick = SamplingTick * 1000LL;
+        const timeval mono = monotime();
+        const timeval wall = walltime();
+        long long when = fTimeout.tv_sec * 1000000LL + fTimeout.tv_usec;
+        long long now = mono.tv_sec * 1000000LL + mono.tv_usec;
+        long long diff = (wall.tv_sec - mono.tv_sec) * 1000000LL
+                       + (wall.tv_usec - mono.tv_usec);
+        // ignore jitter from reading two clocks, but follow clock changes
+        static long long skew;
+        if (diff < skew - 500 || diff > skew + 500)
+            skew = diff;
+        long long phase = ((when + skew) % tick + tick) % tick;
+        when -= phase;
+        if (2 * phase >= tick || when <= now)
+            when += tick;
+        // just past the tick, so that a wall clock second has passed
+        when += 1000;
+        fTimeout = maketime(long(when / 1000000LL), long(when % 1000000LL));
+    }
+}
+
 void YTimer::fuzzTimer() {
-    if (false == fFixed && inrange(DelayFuzziness, 1, 100)) {
+    if (false == fFixed && false == fAligned &&
+        inrange(DelayFuzziness, 1, 100)) {
         // non-fixed timer: configure fuzzy timeout range
         // to allow for merging of several timers
         fFuzziness = (fInterval * DelayFuzziness) / 100L;
@@ -75,8 +114,9 @@ void YTimer::fuzzTimer() {
 }
 
 void YTimer::runTimer() {
+    // expire exactly now, not earlier, to keep the queue order fair
     fTimeout = monotime();
-    fuzzTimer();
+    fFuzziness = 0L;
     enlist();
 }
 
@@ -88,10 +128,9 @@ void YTimer::stopTimer() {
 }
 
 void YTimer::enlist() {
-    if (fRunning == false) {
-        fRunning = true;
-        mainLoop->registerTimer(this);
-    }
+    // also when running, to reorder the timer by its new timeout
+    fRunning = true;
+    mainLoop->registerTimer(this);
 }
 
 void YTimer::disableTimerListener(YTimerListener *listener) {
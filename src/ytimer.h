@@ -27,6 +27,7 @@ public:
     long getInterval() const { return fInterval; }
 
     void setFixed();
+    void setAligned();
 
     void startTimer();
     void startTimer(long ms);
@@ -34,6 +35,7 @@ public:
     void runTimer(); // run timer handler immediately
     bool isRunning() const { return fRunning; }
     bool isFixed() const;
+    bool isAligned() const { return fAligned; }
     bool expires() const;
 
     timeval fuzziness() const { return (timeval) { 0L, fFuzziness*1000L }; }
@@ -45,6 +47,7 @@ public:
 private:
     void enlist();
     void fuzzTimer();
+    void alignTimer();
 
     YTimerListener *fListener;
     struct timeval fTimeout;
@@ -52,6 +55,12 @@ private:
     long fFuzziness;
     bool fRunning;
     bool fFixed;
+    bool fAligned;
+
+    friend class YTimerHeap;
+    friend class YTimerQueue;
+    int fHeapIndex[2];
+    unsigned fPass;     // the timer queue pass which enlisted this timer
 };
 
 #endif
@@ -156,6 +156,8 @@ YWindow::~YWindow() {
     if (fGraphics) {
         delete fGraphics; fGraphics = nullptr;
     }
+    if (flags & wfInvalid)
+        validate();
     if (flags & wfCreated)
         destroy();
 }
@@ -254,9 +256,122 @@ Graphics &YWindow::getGraphics() {
 }
 
 void YWindow::repaint() {
+    // the expose handler of the window decides what to paint
     XClearArea(xapp->display(), handle(), 0, 0, 0, 0, True);
 }
 
+// Invalid areas wait here until the main loop is about to sleep,
+// such that many changes in one event batch cost one paint.
+struct YInvalid {
+    YWindow* window;
+    int count;
+    bool clear;
+    YRect areas[4];
+};
+
+static YArray<YInvalid> invalids;
+static YArray<YInvalid>* painting;
+
+void YWindow::invalidate(const YRect& area, bool clear) {
+    YRect rect(area.intersect(YRect(0, 0, width(), height())));
+    if (rect.pixels() == 0 || destroyed())
+        return;
+
+    YInvalid* d = nullptr;
+    if (flags & wfInvalid) {
+        for (YInvalid& e : invalids)
+            if (e.window == this)
+                d = &e;
+        if (d == nullptr && painting) {
+            for (YInvalid& e : *painting)
+                if (e.window == this)
+                    d = &e;
+        }
+    }
+    if (d == nullptr) {
+        YInvalid e = { this, 0, false, };
+        invalids += e;
+        d = &invalids.last();
+        flags |= wfInvalid;
+    }
+    d->clear |= clear;
+
+    // keep the areas disjoint for the clip rectangles
+    for (int i = 0; i < d->count; ) {
+        if (d->areas[i].overlap(rect)) {
+            rect += d->areas[i];
+            d->areas[i] = d->areas[--d->count];
+            i = 0;
+        } else {
+            ++i;
+        }
+    }
+    if (d->count == int ACOUNT(d->areas)) {
+        for (int i = 0; i < d->count; ++i)
+            rect += d->areas[i];
+        d->count = 0;
+    }
+    d->areas[d->count++] = rect;
+}
+
+void YWindow::validate() {
+    for (YInvalid& e : invalids)
+        if (e.window == this)
+            e.window = nullptr;
+    if (painting) {
+        for (YInvalid& e : *painting)
+            if (e.window == this)
+                e.window = nullptr;
+    }
+    flags &= ~wfInvalid;
+}
+
+bool YWindow::invalidPending() {
+    return invalids.nonempty();
+}
+
+bool YWindow::paintPending() {
+    if (invalids.isEmpty())
+        return false;
+
+    // painting may invalidate other windows, which get a few more rounds.
+    // Whatever remains after that is painted on the next idle pass.
+    for (int round = 0; round < 4 && invalids.nonempty(); ++round) {
+        YArray<YInvalid> batch;
+        batch.swap(invalids);
+        painting = &batch;
+        for (int i = 0; i < batch.getCount(); ++i) {
+            YInvalid d(batch[i]);
+            if (d.window) {
+                d.window->validate();
+                d.window->paintInvalid(d.areas, d.count, d.clear);
+            }
+        }
+        painting = nullptr;
+    }
+    return true;
+}
+
+void YWindow::paintInvalid(const YRect* areas, int count, bool clear) {
+    if (destroyed() || visible() == false)
+        return;
+
+    XRectangle rects[ACOUNT(YInvalid().areas)];
+    YRect bound(areas[0]);
+    for (int i = 0; i < count; ++i) {
+        rects[i] = areas[i];
+        bound += areas[i];
+        if (clear)
+            clearArea(areas[i].x(), areas[i].y(),
+                      areas[i].width(), areas[i].height());
+    }
+
+    Graphics& g(getGraphics());
+    g.setClipRectangles(rects, count);
+    paint(g, bound);
+    g.resetClip();
+}
+
 void YWindow::repaintFocus() {
     repaint();
 }
@@ -265,7 +380,7 @@ bool YWindow::getWindowAttributes(XWindowAttributes* attr) {
     if (fHandle == None)
         return false;
 
-    if (XGetWindowAttributes(xapp->display(), fHandle, attr))
+    if (YPrefetch::getAttributes(fHandle, attr))
         return true;
 
     setDestroyed();
@@ -476,6 +591,7 @@ void YWindow::reparent(YWindow *parent, int x, int y) {
 
     if (notbit(flags, wfDestroyed)) {
         MSG(("--- reparent %lX to %lX", fHandle, parent->handle()));
+        YPrefetch::changed(fHandle, None);
         XReparentWindow(xapp->display(), fHandle, parent->handle(), x, y);
     }
     fX = x;
@@ -485,8 +601,10 @@ void YWindow::reparent(YWindow *parent, int x, int y) {
 void YWindow::show() {
     if (!(flags & (wfVisible | wfDestroyed))) {
         flags |= wfVisible;
-        if (!(flags & wfNullSize))
+        if (!(flags & wfNullSize)) {
+            YPrefetch::changed(fHandle, None);
             XMapWindow(xapp->display(), handle());
+        }
     }
 }
 
@@ -495,6 +613,7 @@ void YWindow::hide() {
         flags &= unsigned(~wfVisible);
         if (!(flags & (wfNullSize | wfDestroyed))) {
             addIgnoreUnmap();
+            YPrefetch::changed(fHandle, None);
             XUnmapWindow(xapp->display(), handle());
         }
     }
@@ -746,38 +865,12 @@ void YWindow::handleEvent(const XEvent &event) {
     }
 }
 
-/// TODO #warning "implement expose compression"
-void YWindow::paintExpose(int ex, int ey, int ew, int eh) {
-    if (ex < 0) {
-        ew += ex;
-        ex = 0;
-    }
-    if (ey < 0) {
-        eh += ey;
-        ey = 0;
-    }
-    ew = min(ew, int(width()) - ex);
-    eh = min(eh, int(height()) - ey);
-    if (ew > 0 && eh > 0) {
-        Graphics& g(getGraphics());
-        XRectangle r = {
-            short(ex),
-            short(ey),
-            static_cast<unsigned short>(ew),
-            static_cast<unsigned short>(eh),
-        };
-        g.setClipRectangles(&r, 1);
-        paint(g, r);
-        g.resetClip();
-    }
-}
-
 void YWindow::handleExpose(const XExposeEvent &expose) {
-    paintExpose(expose.x, expose.y, expose.width, expose.height);
+    invalidate(YRect(expose.x, expose.y, expose.width, expose.height));
 }
 
 void YWindow::handleGraphicsExpose(const XGraphicsExposeEvent &expose) {
-    paintExpose(expose.x, expose.y, expose.width, expose.height);
+    invalidate(YRect(expose.x, expose.y, expose.width, expose.height));
 }
 
 void YWindow::handleConfigure(const XConfigureEvent &configure) {
@@ -1076,6 +1169,7 @@ void YWindow::setGeometry(const YRect &r) {
         fHeight = r.height();
 
         if (flags & wfCreated) {
+            YPrefetch::changed(fHandle, None);
             if (!nullGeometry())
                 XMoveResizeWindow(xapp->display(),
                                   fHandle,
@@ -1093,8 +1187,10 @@ void YWindow::setPosition(int x, int y) {
         fX = x;
         fY = y;
 
-        if (flags & wfCreated)
+        if (flags & wfCreated) {
+            YPrefetch::changed(fHandle, None);
             XMoveWindow(xapp->display(), fHandle, fX, fY);
+        }
 
         configure(YRect2(geometry(), old));
     }
@@ -1107,9 +1203,11 @@ void YWindow::setSize(unsigned width, unsigned height) {
         fWidth = width;
         fHeight = height;
 
-        if (flags & wfCreated)
+        if (flags & wfCreated) {
+            YPrefetch::changed(fHandle, None);
             if (!nullGeometry())
                 XResizeWindow(xapp->display(), fHandle, fWidth, fHeight);
+        }
 
         configure(YRect2(geometry(), old));
     }
@@ -1437,16 +1535,19 @@ void YWindow::removeAccelerator(unsigned int key, unsigned int mod, YWindow *win
 }
 
 void YWindow::deleteProperty(Atom property) {
+    YPrefetch::changed(fHandle, property);
     if (created() && !destroyed())
         XDeleteProperty(xapp->display(), fHandle, property);
 }
 
 void YWindow::setProperty(Atom prop, Atom type, const char* string) {
+    YPrefetch::changed(handle(), prop);
     XChangeProperty(xapp->display(), handle(), prop, type, 8, PropModeReplace,
                     (const unsigned char *) string, int(strlen(string)));
 }
 
 void YWindow::setProperty(Atom prop, Atom type, const Atom* values, int count) {
+    YPrefetch::changed(handle(), prop);
     XChangeProperty(xapp->display(), handle(), prop, type, 32, PropModeReplace,
                     reinterpret_cast<const unsigned char *>(values), count);
 }
@@ -1877,17 +1978,15 @@ void YWindow::scrollWindow(int dx, int dy) {
     if (dx == 0 && dy == 0)
         return ;
 
+    // pending invalid areas would be misplaced by the copy
     if (dx >= int(width()) || dx <= -int(width()) ||
-        dy >= int(height()) || dy <= -int(height()))
+        dy >= int(height()) || dy <= -int(height()) ||
+        hasbit(flags, wfInvalid))
     {
         repaint();
         return ;
     }
 
-    Graphics &g = getGraphics();
-    XRectangle r[2];
-    int nr = 0;
-
     XGCValues gcv;
     gcv.graphics_exposures = False;
     unsigned long gcvflags = GCGraphicsExposures;
@@ -1898,52 +1997,15 @@ void YWindow::scrollWindow(int dx, int dy) {
 
     XFreeGC(xapp->display(), scrollGC);
 
-    dx = - dx;
-    dy = - dy;
-
-    if (dy != 0) {
-        r[nr].x = 0;
-        r[nr].width = static_cast<unsigned short>(width());
-
-        if (dy >= 0) {
-            r[nr].y = 0;
-            r[nr].height = static_cast<unsigned short>(dy);
-        } else {
-            r[nr].height = static_cast<unsigned short>(- dy);
-            r[nr].y = short(int(height()) - int(r[nr].height));
-        }
-        nr++;
+    // invalidate the uncovered strips, which are disjoint
+    const unsigned ax = unsigned(abs(dx)), ay = unsigned(abs(dy));
+    if (ay) {
+        invalidate(YRect(0, dy > 0 ? int(height() - ay) : 0, width(), ay));
     }
-    if (dx != 0) {
-        r[nr].y = 0;
-        r[nr].height = static_cast<unsigned short>(height()); // !!! optimize
-
-        if (dx >= 0) {
-            r[nr].x = 0;
-            r[nr].width = static_cast<unsigned short>(dx);
-        } else {
-            r[nr].width = static_cast<unsigned short>(- dx);
-            r[nr].x = short(int(width()) - int(r[nr].width));
-        }
-        nr++;
+    if (ax) {
+        invalidate(YRect(dx > 0 ? int(width() - ax) : 0, dy < 0 ? int(ay) : 0,
+                     ax, height() - ay));
     }
-    //msg("nr=%d", nr);
-
-    g.setClipRectangles(r, nr);
-
-    XRectangle re;
-    if (nr == 1)
-        re = r[0];
-    else {
-        re.x = 0;
-        re.y = 0;
-        re.width = static_cast<unsigned short>(width());
-        re.height = static_cast<unsigned short>(height());
-    }
-
-    paint(g, YRect(re.x, re.y, re.width, re.height)); // !!! add flag to do minimal redraws
-
-    g.resetClip();
 }
 
 void YWindow::clearWindow() {
@@ -89,6 +89,10 @@ public:
 
     virtual void repaint();
     virtual void repaintFocus();
+    // paint an area once before the main loop sleeps again
+    void invalidate(const YRect& area, bool clear = false);
+    static bool paintPending();
+    static bool invalidPending();
 
     void readAttributes();
     void reparent(YWindow *parent, int x, int y);
@@ -113,6 +117,7 @@ public:
     virtual void configure(const YRect2& r2);
 
     virtual void paint(Graphics &g, const YRect &r);
+    virtual void paintInvalid(const YRect* areas, int count, bool clear);
 
     virtual void handleEvent(const XEvent &event);
 
@@ -174,8 +179,6 @@ public:
     YWindow *window() { return this; }
     YWindow *nextSibling() { return nextWindow(); }
 
-    void paintExpose(int ex, int ey, int ew, int eh);
-
     Graphics& getGraphics();
     virtual ref<YImage> getGradient() {
         return (parent() ? parent()->getGradient() : null); }
@@ -297,11 +300,13 @@ private:
         wfToplevel  = 1 << 4,
         wfNullSize  = 1 << 5,
         wfFocused   = 1 << 6,
+        wfInvalid   = 1 << 7,
     };
 
     Window create();
     void adopt();
     void destroy();
+    void validate();
 
     void insertWindow();
     void removeWindow();
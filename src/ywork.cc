@@ -0,0 +1,186 @@
+/*
+ *  IceWM - Worker threads for blocking jobs
+ *
+ *  Release under terms of the GNU Library General Public License
+ */
+
+#include "config.h"
+#include "mstring.h"
+#include "ywork.h"
+#include "base.h"
+#include "intl.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <unistd.h>
+#ifdef HAVE_SYS_EVENTFD_H
+#include <sys/eventfd.h>
+#endif
+
+YWorkerPool::Queue::Queue() :
+    fWorkers(0),
+    fIdle(0),
+    fUsers(1),
+    fStopping(false),
+    fSignal(-1)
+{
+    pthread_mutex_init(&fMutex, nullptr);
+    pthread_cond_init(&fWakeup, nullptr);
+}
+
+YWorkerPool::Queue::~Queue() {
+    for (YJob* job : fPending)
+        delete job;
+    for (YJob* job : fFinished)
+        delete job;
+    pthread_cond_destroy(&fWakeup);
+    pthread_mutex_destroy(&fMutex);
+}
+
+YWorkerPool::YWorkerPool() :
+    fQueue(new Queue)
+{
+#ifdef HAVE_SYS_EVENTFD_H
+    fQueue->fSignal = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (fQueue->fSignal == -1)
+        die(2, _("Failed to create eventfd (errno=%d)."), errno);
+    registerPoll(fQueue->fSignal);
+#else
+    int fds[2];
+    if (pipe(fds) != 0)
+        die(2, _("Failed to create anonymous pipe (errno=%d)."), errno);
+    for (int fd : fds) {
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    fQueue->fSignal = fds[1];
+    registerPoll(fds[0]);
+#endif
+}
+
+YWorkerPool::~YWorkerPool() {
+    Queue* q = fQueue;
+    pthread_mutex_lock(&q->fMutex);
+    q->fStopping = true;
+    for (YJob* job : q->fRunning)
+        job->fCancelled = true;
+    pthread_cond_broadcast(&q->fWakeup);
+    // workers no longer signal once stopping
+    if (q->fSignal != fd())
+        close(q->fSignal);
+    q->fSignal = -1;
+    bool last = (--q->fUsers == 0);
+    pthread_mutex_unlock(&q->fMutex);
+
+    // a job which still runs keeps the queue, but is not waited for
+    if (last)
+        delete q;
+    closePoll();
+}
+
+void YWorkerPool::submit(YJob* job) {
+    Queue* q = fQueue;
+    pthread_mutex_lock(&q->fMutex);
+    q->fPending.append(job);
+    if (q->fIdle < q->fPending.getCount() && q->fWorkers < MaxWorkers) {
+        // workers must not receive the signals of the main thread
+        sigset_t all, old;
+        sigfillset(&all);
+        pthread_sigmask(SIG_SETMASK, &all, &old);
+        pthread_t thread;
+        if (pthread_create(&thread, nullptr, start, q) == 0) {
+            pthread_detach(thread);
+            q->fWorkers++;
+            q->fUsers++;
+        }
+        else
+            fail("pthread_create");
+        pthread_sigmask(SIG_SETMASK, &old, nullptr);
+    }
+    pthread_cond_signal(&q->fWakeup);
+    pthread_mutex_unlock(&q->fMutex);
+}
+
+bool YWorkerPool::cancel(YJob* job) {
+    Queue* q = fQueue;
+    bool found = true;
+    pthread_mutex_lock(&q->fMutex);
+    if (findRemove(q->fPending, job))
+        delete job;
+    else if (0 <= find(q->fRunning, job) || 0 <= find(q->fFinished, job))
+        job->fCancelled = true;
+    else
+        found = false;
+    pthread_mutex_unlock(&q->fMutex);
+    return found;
+}
+
+void* YWorkerPool::start(void* queue) {
+    static_cast<Queue*>(queue)->work();
+    return nullptr;
+}
+
+void YWorkerPool::Queue::work() {
+    pthread_mutex_lock(&fMutex);
+    while (fStopping == false) {
+        if (fPending.isEmpty()) {
+            fIdle++;
+            pthread_cond_wait(&fWakeup, &fMutex);
+            fIdle--;
+            continue;
+        }
+        YJob* job = fPending[0];
+        fPending.remove(0);
+        fRunning.append(job);
+        pthread_mutex_unlock(&fMutex);
+
+        job->run();
+
+        pthread_mutex_lock(&fMutex);
+        findRemove(fRunning, job);
+        if (fStopping) {
+            delete job;
+            break;
+        }
+        fFinished.append(job);
+        wakeup();
+    }
+    bool last = (--fUsers == 0);
+    pthread_mutex_unlock(&fMutex);
+    if (last)
+        delete this;
+}
+
+void YWorkerPool::Queue::wakeup() {
+#ifdef HAVE_SYS_EVENTFD_H
+    uint64_t one = 1;
+#else
+    char one = 1;
+#endif
+    if (write(fSignal, &one, sizeof one) == -1 && errno != EAGAIN)
+        fail("write worker signal");
+}
+
+void YWorkerPool::notifyRead() {
+    char buf[64];
+    while (read(fd(), buf, sizeof buf) > 0) { }
+
+    // a completion may submit or cancel other jobs
+    for (;;) {
+        Queue* q = fQueue;
+        pthread_mutex_lock(&q->fMutex);
+        YJob* job = q->fFinished.nonempty() ? q->fFinished[0] : nullptr;
+        bool cancelled = job && job->fCancelled;
+        if (job)
+            q->fFinished.remove(0);
+        pthread_mutex_unlock(&q->fMutex);
+        if (job == nullptr)
+            break;
+        if (cancelled == false)
+            job->done();
+        delete job;
+    }
+}
+
+// vim: set sw=4 ts=4 et:
@@ -0,0 +1,74 @@
+#ifndef YWORK_H
+#define YWORK_H
+
+#include "ypoll.h"
+#include "yarray.h"
+#include <pthread.h>
+
+// A blocking task which runs on a worker thread.
+// Submit it with mainLoop->submitJob, which takes ownership.
+// Only run is called on the worker, where it must not use Xlib
+// or other state of the main thread. Afterwards done is called
+// on the main thread, unless the job was cancelled, and then
+// the job is deleted.
+class YJob {
+public:
+    YJob() : fCancelled(false) { }
+    virtual ~YJob() { }
+
+    virtual void run() = 0;
+    virtual void done() = 0;
+
+private:
+    friend class YWorkerPool;
+    bool fCancelled;
+};
+
+// A few threads which run jobs in the order of submission.
+// Completions are signalled to the main loop through an eventfd.
+// The workers are detached: on destruction running jobs are cancelled,
+// but not waited for, since they may block for a long time.
+class YWorkerPool: public YPollBase {
+public:
+    YWorkerPool();
+    virtual ~YWorkerPool();
+
+    void submit(YJob* job);
+    bool cancel(YJob* job);
+
+    virtual void notifyRead();
+    virtual bool forRead() { return true; }
+
+private:
+    enum { MaxWorkers = 2 };
+
+    // The state which is shared with the workers. The last of the pool
+    // and the workers to leave deletes it.
+    struct Queue {
+        Queue();
+        ~Queue();
+
+        pthread_mutex_t fMutex;
+        pthread_cond_t fWakeup;
+        int fWorkers;
+        int fIdle;
+        int fUsers;
+        bool fStopping;
+        int fSignal;
+
+        YArray<YJob*> fPending;
+        YArray<YJob*> fRunning;
+        YArray<YJob*> fFinished;
+
+        void work();
+        void wakeup();
+    };
+
+    Queue* fQueue;
+
+    static void* start(void* queue);
+};
+
+#endif
+
+// vim: set sw=4 ts=4 et:
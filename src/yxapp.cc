@@ -7,6 +7,8 @@
 #include "ypointer.h"
 #include "yxcontext.h"
 #include "yconfig.h"
+#include "yprefs.h"
+#include "ylatency.h"
 #include "guievent.h"
 #include "intl.h"
 #undef override
@@ -16,11 +18,17 @@
 #endif
 #include <X11/extensions/Xcomposite.h>
 #include <X11/extensions/XShm.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#ifdef CONFIG_XCB
+#include <X11/Xlib-xcb.h>
+#endif
 
 YXApplication *xapp = nullptr;
 
 YDesktop *desktop = nullptr;
 YContext<YWindow> windowContext("windowContext", false);
+static YLatency eventLatency("event", false);
 
 bool YXApplication::synchronizeX11;
 bool YXApplication::alphaBlending;
@@ -727,6 +735,7 @@ void YXApplication::replayEvent() {
     if (!fReplayEvent) {
         fReplayEvent = true;
         XAllowEvents(xapp->display(), ReplayPointer, CurrentTime);
+        flushXEvents();
     }
 }
 
@@ -776,6 +785,7 @@ bool YXApplication::grabEvents(YWindow *win, Cursor ptr,
         }
     }
     XAllowEvents(xapp->display(), SyncPointer, CurrentTime);
+    flushXEvents();
 
     fXGrabWindow = win;
     fGrabWindow = win;
@@ -1091,7 +1101,9 @@ YXApplication::YXApplication(int *argc, char ***argv, const char *displayName):
     fKeysymsPer(0),
     fGrabTree(false),
     fGrabMouse(false),
-    fReplayEvent(false)
+    fReplayEvent(false),
+    fXFlushes(0),
+    fXDropped(0)
 {
     xapp = this;
     xfd.registerPoll(ConnectionNumber(display()));
@@ -1151,7 +1163,158 @@ void YXApplication::initExtensions(Display* dpy) {
     xshm.init(dpy, XShmQueryExtension, XShmQueryVersion);
 }
 
+// Large images go to the server through a shared memory segment,
+// which is kept for a few seconds to serve a series of uploads,
+// like the wallpapers for several monitors.
+class YShmUpload : public YTimerListener {
+public:
+    YShmUpload() : fInfo(), fSize(0), fRemote(false) { }
+
+    bool put(Drawable drawable, GC gc, XImage* image, int x, int y);
+    void release();
+    // stop the timer and release the segment before the main loop ends
+    void clear() { fTimer = null; release(); }
+    virtual bool handleTimer(YTimer* timer) { release(); return false; }
+
+private:
+    enum { MinimumSize = 64 * 1024 };
+    bool reserve(size_t size);
+    static int attachError(Display* display, XErrorEvent* xev);
+
+    XShmSegmentInfo fInfo;
+    size_t fSize;
+    bool fRemote;
+    lazy<YTimer> fTimer;
+    static bool fFailed;
+    static int fOpcode;
+    static XErrorHandler fPrevious;
+};
+
+bool YShmUpload::fFailed;
+int YShmUpload::fOpcode;
+XErrorHandler YShmUpload::fPrevious;
+static YShmUpload shmUpload;
+
+// only the errors of MIT-SHM requests concern the attach
+int YShmUpload::attachError(Display* display, XErrorEvent* xev) {
+    if (xev->request_code == fOpcode) {
+        fFailed = true;
+        return Success;
+    }
+    return fPrevious ? fPrevious(display, xev) : Success;
+}
+
+bool YShmUpload::reserve(size_t size) {
+    if (size <= fSize)
+        return true;
+
+    release();
+    int event, error;
+    if (fOpcode == 0 && XQueryExtension(xapp->display(), SHMNAME,
+                                        &fOpcode, &event, &error) == False)
+        return false;
+    int id = shmget(IPC_PRIVATE, size, IPC_CREAT | 0600);
+    if (id < 0)
+        return false;
+    void* addr = shmat(id, nullptr, 0);
+    if (addr == (void *) -1) {
+        shmctl(id, IPC_RMID, nullptr);
+        return false;
+    }
+    fInfo.shmid = id;
+    fInfo.shmaddr = static_cast<char *>(addr);
+    fInfo.readOnly = False;
+
+    // a server on another host fails to attach
+    fFailed = false;
+    fPrevious = XSetErrorHandler(attachError);
+    Status attached = XShmAttach(xapp->display(), &fInfo);
+    XSync(xapp->display(), False);
+    XSetErrorHandler(fPrevious);
+    fPrevious = nullptr;
+    // the segment goes away when both sides detach
+    shmctl(id, IPC_RMID, nullptr);
+
+    if (attached == False || fFailed) {
+        shmdt(addr);
+        fRemote = true;
+        return false;
+    }
+    fSize = size;
+    return true;
+}
+
+void YShmUpload::release() {
+    if (fSize) {
+        XShmDetach(xapp->display(), &fInfo);
+        XSync(xapp->display(), False);
+        shmdt(fInfo.shmaddr);
+        fSize = 0;
+    }
+}
+
+bool YShmUpload::put(Drawable drawable, GC gc, XImage* image, int x, int y) {
+    size_t size = size_t(image->bytes_per_line) * image->height;
+    if (size < MinimumSize || image->format != ZPixmap ||
+        fRemote || xshm.supported == false)
+        return false;
+
+    Visual* visual = xapp->visualForDepth(image->depth);
+    XImage* shared = XShmCreateImage(xapp->display(), visual, image->depth,
+                                     ZPixmap, nullptr, &fInfo,
+                                     image->width, image->height);
+    if (shared == nullptr)
+        return false;
+
+    bool done = false;
+    if (shared->bits_per_pixel == image->bits_per_pixel &&
+        shared->byte_order == image->byte_order &&
+        reserve(size_t(shared->bytes_per_line) * shared->height))
+    {
+        shared->data = fInfo.shmaddr;
+        int length = min(shared->bytes_per_line, image->bytes_per_line);
+        for (int row = 0; row < image->height; ++row) {
+            memcpy(shared->data + row * shared->bytes_per_line,
+                   image->data + row * image->bytes_per_line, length);
+        }
+        XShmPutImage(xapp->display(), drawable, gc, shared,
+                     0, 0, x, y, image->width, image->height, False);
+        // the next upload reuses the segment
+        XSync(xapp->display(), False);
+        fTimer->setTimer(5000L, this, true);
+        done = true;
+    }
+    shared->data = nullptr;
+    XDestroyImage(shared);
+    return done;
+}
+
+void YXApplication::putImage(Drawable drawable, GC gc, XImage* image,
+                             int x, int y)
+{
+    timeval start = monotime();
+    bool shared = shmUpload.put(drawable, gc, image, x, y);
+    if (shared == false) {
+        XPutImage(display(), drawable, gc, image,
+                  0, 0, x, y, image->width, image->height);
+    }
+    if (image->width * image->height >= 0x10000 &&
+        YTrace::traces("upload"))
+    {
+        if (shared == false)
+            XSync(display(), False);
+        timeval took = monotime() - start;
+        tlog("upload: %dx%dx%d image in %.1f ms by %s",
+             image->width, image->height, image->depth,
+             took.tv_sec * 1e3 + took.tv_usec * 1e-3,
+             shared ? "shared memory" : "XPutImage");
+    }
+}
+
 YXApplication::~YXApplication() {
+    Graphics::clearImages();
+    GraphicsBuffer::clearPool();
+    shmUpload.clear();
     if (fColormap32)
         XFreeColormap(display(), fColormap32);
     if (fKeycodeMap)
@@ -1164,13 +1327,231 @@ YXApplication::~YXApplication() {
     xapp = nullptr;
 }
 
+// The window which is the subject of a structure event.
+static Window subjectWindow(const XEvent& xev) {
+    switch (xev.type) {
+    case CreateNotify:      return xev.xcreatewindow.window;
+    case DestroyNotify:     return xev.xdestroywindow.window;
+    case UnmapNotify:       return xev.xunmap.window;
+    case MapNotify:         return xev.xmap.window;
+    case MapRequest:        return xev.xmaprequest.window;
+    case ReparentNotify:    return xev.xreparent.window;
+    case ConfigureNotify:   return xev.xconfigure.window;
+    case ConfigureRequest:  return xev.xconfigurerequest.window;
+    case GravityNotify:     return xev.xgravity.window;
+    case CirculateNotify:   return xev.xcirculate.window;
+    case CirculateRequest:  return xev.xcirculaterequest.window;
+    default:                return xev.xany.window;
+    }
+}
+
+// Add the fields of an earlier request which a later one doesn't change.
+// The sibling and the stack mode are only taken together from one request.
+static void foldConfigureRequest(XConfigureRequestEvent& later,
+                                 const XConfigureRequestEvent& early)
+{
+    unsigned long missing = early.value_mask & ~later.value_mask;
+    if (later.value_mask & (CWSibling | CWStackMode))
+        missing &= ~(CWSibling | CWStackMode);
+    if (missing & CWX)
+        later.x = early.x;
+    if (missing & CWY)
+        later.y = early.y;
+    if (missing & CWWidth)
+        later.width = early.width;
+    if (missing & CWHeight)
+        later.height = early.height;
+    if (missing & CWBorderWidth)
+        later.border_width = early.border_width;
+    if (missing & CWSibling)
+        later.above = early.above;
+    if (missing & CWStackMode)
+        later.detail = early.detail;
+    later.value_mask |= missing;
+}
+
+// Merge an earlier expose area into the kept expose events of its window,
+// which stay disjoint and at most four, like the invalid areas of YWindow.
+// Return false if the area is to be kept as an event of its own.
+static bool foldExpose(YArray<XEvent>& batch, YArray<int>& expose,
+                       const XExposeEvent& xev, int& dropped)
+{
+    const int limit = 4;
+    YRect rect(xev.x, xev.y, xev.width, xev.height);
+    int into = -1, kept = 0;
+    for (int j = 0; j < expose.getCount(); ++j) {
+        const XExposeEvent& keep = batch[expose[j]].xexpose;
+        if (keep.window != xev.window || j == into)
+            continue;
+        YRect area(keep.x, keep.y, keep.width, keep.height);
+        if (area.overlap(rect) == 0)
+            continue;
+        rect += area;
+        if (into < 0) {
+            into = j;
+        } else {
+            batch[expose[j]].type = 0;
+            ++dropped;
+            expose.remove(j);
+            if (j < into)
+                --into;
+        }
+        // the larger area may now overlap another
+        j = -1;
+    }
+    for (int k : expose)
+        kept += (batch[k].xexpose.window == xev.window);
+    if (into < 0) {
+        if (kept < limit)
+            return false;
+        // too many areas: merge all of them into one
+        for (int j = expose.getCount(); 0 <= --j; ) {
+            const XExposeEvent& keep = batch[expose[j]].xexpose;
+            if (keep.window == xev.window) {
+                rect += YRect(keep.x, keep.y, keep.width, keep.height);
+                if (into >= 0) {
+                    batch[expose[into]].type = 0;
+                    ++dropped;
+                    expose.remove(into);
+                }
+                into = j;
+            }
+        }
+    }
+    XExposeEvent& keep = batch[expose[into]].xexpose;
+    keep.x = rect.xx;
+    keep.y = rect.yy;
+    keep.width = int(rect.ww);
+    keep.height = int(rect.hh);
+    return true;
+}
+
+// Merge queued events which are superseded by a later event,
+// before they are dispatched. The remaining events keep their order.
+// Return the number of events dropped.
+int YXApplication::compressEvents() {
+    if (false == (compressMotionEvents | compressPropertyEvents |
+                  compressConfigureRequests | compressExposeEvents))
+        return 0;
+
+    const int count = min(XEventsQueued(display(), QueuedAlready), 500);
+    if (count < 2)
+        return 0;
+
+    fEventBatch.shrink(0);
+    for (int i = 0; i < count; ++i) {
+        XEvent xev;
+        XNextEvent(display(), &xev);
+        fEventBatch.append(xev);
+    }
+
+    // For each rule, the indices of the latest kept events, per window.
+    YArray<int> motion, property, configure, expose;
+    int dropped = 0;
+
+    for (int i = count; 0 <= --i; ) {
+        XEvent& xev = fEventBatch[i];
+        bool drop = false;
+
+        switch (xev.type) {
+        case MotionNotify:
+            if (compressMotionEvents) {
+                for (int k : motion) {
+                    const XMotionEvent& keep = fEventBatch[k].xmotion;
+                    if (keep.window == xev.xmotion.window &&
+                        keep.subwindow == xev.xmotion.subwindow) {
+                        drop = true;
+                        break;
+                    }
+                }
+                if (drop == false)
+                    motion.append(i);
+            }
+            break;
+        case ButtonPress:
+        case ButtonRelease:
+        case KeyPress:
+        case KeyRelease:
+        case EnterNotify:
+        case LeaveNotify:
+            // motion can't be reordered around other input
+            motion.shrink(0);
+            break;
+        case PropertyNotify:
+            if (compressPropertyEvents) {
+                for (int k : property) {
+                    const XPropertyEvent& keep = fEventBatch[k].xproperty;
+                    if (keep.window == xev.xproperty.window &&
+                        keep.atom == xev.xproperty.atom) {
+                        drop = true;
+                        break;
+                    }
+                }
+                if (drop == false)
+                    property.append(i);
+            }
+            break;
+        case ConfigureRequest:
+            if (compressConfigureRequests) {
+                for (int k : configure) {
+                    XConfigureRequestEvent& keep =
+                        fEventBatch[k].xconfigurerequest;
+                    if (keep.window == xev.xconfigurerequest.window) {
+                        foldConfigureRequest(keep, xev.xconfigurerequest);
+                        drop = true;
+                        break;
+                    }
+                }
+                if (drop == false)
+                    configure.append(i);
+            }
+            break;
+        case Expose:
+            if (compressExposeEvents) {
+                drop = foldExpose(fEventBatch, expose, xev.xexpose, dropped);
+                if (drop == false)
+                    expose.append(i);
+            }
+            break;
+        default:
+            break;
+        }
+
+        if (drop) {
+            xev.type = 0;
+            ++dropped;
+        }
+        else if (configure.nonempty() && xev.type != ConfigureRequest) {
+            // a request can't be moved past other events for its window
+            Window subject = subjectWindow(xev);
+            for (int j = configure.getCount(); 0 <= --j; ) {
+                if (fEventBatch[configure[j]].xconfigurerequest.window ==
+                    subject)
+                    configure.remove(j);
+            }
+        }
+    }
+
+    // XPutBackEvent prepends, so return the events in reverse order.
+    for (int i = count; 0 <= --i; ) {
+        if (fEventBatch[i].type)
+            XPutBackEvent(display(), &fEventBatch[i]);
+    }
+    return dropped;
+}
+
 bool YXApplication::handleXEvents() {
     const int prratio = 3;
     int retrieved = 0;
+    int events = 0;
+    int dropped = compressEvents();
+    fXDropped += dropped;
+    fXFlushes = 0;
     for (; retrieved < XPending(display()); retrieved += prratio - 1) {
         XEvent xev;
 
         XNextEvent(display(), &xev);
+        ++events;
 #ifdef DEBUG
         xeventcount++;
 #endif
@@ -1222,20 +1603,71 @@ bool YXApplication::handleXEvents() {
                 {
                     if (!fReplayEvent) {
                         XAllowEvents(xapp->display(), SyncPointer, CurrentTime);
+                        // the frozen pointer must be released promptly
+                        flushXEvents();
                     }
                 }
             }
         }
-        XFlush(display());
     }
-    return retrieved > 0;
+    // paint what the batch and the timers invalidated, once per window
+    bool painted = YWindow::paintPending();
+    if (events || painted) {
+        // one flush for the whole batch
+        flushXEvents();
+        if (events && YTrace::traces("flush"))
+            tlog("flush: %d events, %d flushes, %d compressed (%d total)",
+                 events, fXFlushes, dropped, fXDropped);
+    }
+    // don't sleep while invalid areas remain
+    return retrieved > 0 || YWindow::invalidPending();
 }
 
 bool YXApplication::handleIdle() {
     return handleXEvents();
 }
 
+// a stable name per event type, for extensions their base plus offset
+static const char* eventKey(int type) {
+    if (type < LASTEvent)
+        return eventName(type);
+
+    static const char* keys[128];
+    const int index = type & 127;
+    if (keys[index] == nullptr) {
+        static const struct {
+            const char* name;
+            const YExtension& ext;
+        } exts[] = {
+            { "Composite", composite },
+            { "Damage", damage },
+            { "XFixes", fixes },
+            { "Render", render },
+            { "Shape", shapes },
+            { "RandR", xrandr },
+            { "Xinerama", xinerama },
+            { "MIT-SHM", xshm },
+        };
+        const char* name = "Extension";
+        int base = LASTEvent;
+        for (const auto& e : exts) {
+            if (e.ext.supported && inrange(e.ext.eventBase, base, type)) {
+                name = e.name;
+                base = e.ext.eventBase;
+            }
+        }
+        char buf[64];
+        snprintf(buf, sizeof buf, "%s+%d", name, type - base);
+        keys[index] = newstr(buf);
+    }
+    return keys[index];
+}
+
 void YXApplication::handleWindowEvent(Window xwindow, XEvent &xev) {
+    const int type = xev.type;
+    const unsigned long serial = xev.xany.serial;
+    timeval start = monotime();
+
     struct {
         YWindow *ptr;
     } window = { nullptr };
@@ -1298,10 +1730,17 @@ void YXApplication::handleWindowEvent(Window xwindow, XEvent &xev) {
     }
     if (xev.type == KeyPress || xev.type == KeyRelease) ///!!!
         afterWindowEvent(xev);
+
+    const char* key = eventKey(type);
+    long micros = eventLatency.account(key, start);
+    if (YLatency::isSlow(micros))
+        tlog("slow event dispatch: %s for window 0x%lx, serial %lu took %ld ms",
+             key, xwindow, serial, micros / 1000L);
 }
 
 void YXApplication::flushXEvents() {
     XFlush(display());
+    ++fXFlushes;
 }
 
 int YXApplication::handleError(XErrorEvent* xev) {
@@ -1491,9 +1930,13 @@ YTextProperty::YTextProperty(const char* str) {
 }
 
 YTextProperty::YTextProperty(Window handle, Atom property) {
+    unsigned long after = 0;
     nitems = 0;
     value = nullptr;
-    if (XGetTextProperty(xapp->display(), handle, this, property)) {
+    if (YPrefetch::getProperty(handle, property, 1000000L, false,
+                               AnyPropertyType, &encoding, &format,
+                               &nitems, &after, &value) == Success &&
+        encoding != None && value) {
         if (encoding == _XA_COMPOUND_TEXT) {
             char** list = nullptr;
             int count = 0;
@@ -1528,8 +1971,8 @@ const YProperty& YProperty::update() {
     discard();
     int fmt = 0;
     fRequest = fProp;
-    if (XGetWindowProperty(xapp->display(), fWind, fProp, 0L, fLimit, fDelete,
-                           fKind, &fType, &fmt, &fSize, &fMore, &fData) ==
+    if (YPrefetch::getProperty(fWind, fProp, fLimit, fDelete, fKind,
+                               &fType, &fmt, &fSize, &fMore, &fData) ==
         Success && fData && fSize && fmt == fBits && (fKind == fType || !fKind))
     {
     } else {
@@ -1540,14 +1983,325 @@ const YProperty& YProperty::update() {
 
 void YProperty::append(void const* data, int count) const {
     unsigned char const* bytes = reinterpret_cast<unsigned char const*>(data);
+    YPrefetch::changed(fWind, fProp);
     XChangeProperty(xapp->display(), fWind, fProp, fKind, fBits,
                     PropModeAppend, bytes, count);
 }
 
 void YProperty::replace(void const* data, int count) const {
     unsigned char const* bytes = reinterpret_cast<unsigned char const*>(data);
+    YPrefetch::changed(fWind, fProp);
     XChangeProperty(xapp->display(), fWind, fProp, fKind, fBits,
                     PropModeReplace, bytes, count);
 }
 
+static YContext<YPrefetch> prefetches;
+int YPrefetch::fRoundTrips;
+
+YPrefetch::YPrefetch(Window window, const Atom* atoms, int count):
+    fWindow(window),
+    fPrevious(prefetches.find(window)),
+    fStartTrips(fRoundTrips),
+    fServed(0),
+    fWaited(false),
+    fAttributed(false),
+    fAttributes(),
+    fListing(0),
+    fWindowAttributes(0),
+    fGeometry(0),
+    fConnection(nullptr)
+{
+#ifdef CONFIG_XCB
+    // enough for names, classes and hints, but not for icons
+    const uint32_t limit = 1024;
+
+    fConnection = XGetXCBConnection(xapp->display());
+    fWindowAttributes = xcb_get_window_attributes(fConnection, window).sequence;
+    fGeometry = xcb_get_geometry(fConnection, window).sequence;
+    fListing = xcb_list_properties(fConnection, window).sequence;
+    for (int i = 0; i < count; ++i) {
+        fAtoms += atoms[i];
+        fCookies += xcb_get_property(fConnection, false, window, atoms[i],
+                                     XCB_GET_PROPERTY_TYPE_ANY,
+                                     0, limit).sequence;
+    }
+#endif
+    prefetches.save(window, this);
+}
+
+YPrefetch::~YPrefetch() {
+#ifdef CONFIG_XCB
+    forget(None);
+    if (fListing)
+        xcb_discard_reply(fConnection, fListing);
+    for (unsigned sequence : fCookies)
+        if (sequence)
+            xcb_discard_reply(fConnection, sequence);
+#endif
+    if (fPrevious)
+        prefetches.save(fWindow, fPrevious);
+    else
+        prefetches.remove(fWindow);
+}
+
+void YPrefetch::waited() {
+    if (fWaited == false) {
+        fWaited = true;
+        ++fRoundTrips;
+    }
+}
+
+#ifdef CONFIG_XCB
+static Visual* visualOf(Display* display, VisualID id) {
+    for (int i = 0; i < ScreenCount(display); ++i) {
+        Screen* screen = ScreenOfDisplay(display, i);
+        for (int d = 0; d < screen->ndepths; ++d) {
+            Depth* depth = &screen->depths[d];
+            for (int v = 0; v < depth->nvisuals; ++v)
+                if (depth->visuals[v].visualid == id)
+                    return &depth->visuals[v];
+        }
+    }
+    return nullptr;
+}
+
+static Screen* screenOf(Display* display, Window root) {
+    for (int i = 0; i < ScreenCount(display); ++i)
+        if (RootWindow(display, i) == root)
+            return ScreenOfDisplay(display, i);
+    return nullptr;
+}
+#endif
+
+bool YPrefetch::attributed(XWindowAttributes* attributes) {
+#ifdef CONFIG_XCB
+    if (fAttributed == false && fWindowAttributes) {
+        xcb_get_window_attributes_cookie_t cookie = { fWindowAttributes };
+        xcb_get_geometry_cookie_t geocookie = { fGeometry };
+        xcb_generic_error_t* error = nullptr;
+        fWindowAttributes = fGeometry = 0;
+        waited();
+        xcb_get_window_attributes_reply_t* attr =
+            xcb_get_window_attributes_reply(fConnection, cookie, &error);
+        free(error);
+        error = nullptr;
+        xcb_get_geometry_reply_t* geo =
+            xcb_get_geometry_reply(fConnection, geocookie, &error);
+        free(error);
+        if (attr && geo) {
+            // fill in like XGetWindowAttributes
+            Display* display = xapp->display();
+            XWindowAttributes& wa = fAttributes;
+            wa.x = geo->x;
+            wa.y = geo->y;
+            wa.width = geo->width;
+            wa.height = geo->height;
+            wa.border_width = geo->border_width;
+            wa.depth = geo->depth;
+            wa.root = geo->root;
+            wa.screen = screenOf(display, geo->root);
+            wa.visual = visualOf(display, attr->visual);
+            wa.c_class = attr->_class;
+            wa.bit_gravity = attr->bit_gravity;
+            wa.win_gravity = attr->win_gravity;
+            wa.backing_store = attr->backing_store;
+            wa.backing_planes = attr->backing_planes;
+            wa.backing_pixel = attr->backing_pixel;
+            wa.save_under = attr->save_under;
+            wa.colormap = attr->colormap;
+            wa.map_installed = attr->map_is_installed;
+            wa.map_state = attr->map_state;
+            wa.all_event_masks = attr->all_event_masks;
+            wa.your_event_mask = attr->your_event_mask;
+            wa.do_not_propagate_mask = attr->do_not_propagate_mask;
+            wa.override_redirect = attr->override_redirect;
+            fAttributed = true;
+        }
+        free(attr);
+        free(geo);
+    }
+    if (fAttributed)
+        *attributes = fAttributes;
+    return fAttributed;
+#else
+    return false;
+#endif
+}
+
+bool YPrefetch::fetched(Atom property, long limit, bool remove, Atom type,
+                        Atom* actual, int* format, unsigned long* count,
+                        unsigned long* after, unsigned char** data)
+{
+#ifdef CONFIG_XCB
+    if (remove) {
+        forget(property);
+        return false;
+    }
+    int k = find(fAtoms, property);
+    if (k < 0 || fCookies[k] == 0)
+        return false;
+
+    xcb_get_property_cookie_t cookie = { fCookies[k] };
+    xcb_generic_error_t* error = nullptr;
+    fCookies[k] = 0;
+    waited();
+    xcb_get_property_reply_t* reply =
+        xcb_get_property_reply(fConnection, cookie, &error);
+    free(error);
+    if (reply == nullptr)
+        return false;
+
+    // mimic XGetWindowProperty, which gives 32-bit values as longs
+    const unsigned unit = reply->format / 8;
+    const unsigned long have = reply->value_len * unit;
+    const unsigned long wanted = (unsigned long) limit * 4;
+    bool served = true;
+    if (reply->type == None || unit == 0) {
+        *actual = None;
+        *format = 0;
+        *count = *after = 0;
+        *data = nullptr;
+    }
+    else if (type != AnyPropertyType && type != reply->type) {
+        *actual = reply->type;
+        *format = reply->format;
+        *count = 0;
+        *after = have + reply->bytes_after;
+        *data = nullptr;
+    }
+    else if (reply->bytes_after && have < wanted) {
+        served = false;
+    }
+    else {
+        unsigned long items = min<unsigned long>(reply->value_len,
+                                                 wanted / unit);
+        size_t size = items * (unit == 4 ? sizeof(long) :
+                               unit == 2 ? sizeof(short) : 1);
+        unsigned char* bytes = (unsigned char *) malloc(size + 1);
+        const void* value = xcb_get_property_value(reply);
+        if (unit == 4) {
+            const int32_t* source = static_cast<const int32_t*>(value);
+            long* target = reinterpret_cast<long*>(bytes);
+            for (unsigned long i = 0; i < items; ++i)
+                target[i] = source[i];
+        }
+        else if (unit == 2) {
+            const int16_t* source = static_cast<const int16_t*>(value);
+            short* target = reinterpret_cast<short*>(bytes);
+            for (unsigned long i = 0; i < items; ++i)
+                target[i] = source[i];
+        }
+        else {
+            memcpy(bytes, value, items);
+        }
+        bytes[size] = 0;
+        *actual = reply->type;
+        *format = reply->format;
+        *count = items;
+        *after = have + reply->bytes_after - items * unit;
+        *data = bytes;
+    }
+    free(reply);
+    return served;
+#else
+    return false;
+#endif
+}
+
+bool YPrefetch::listed(int* count, Atom** atoms) {
+#ifdef CONFIG_XCB
+    if (fListing == 0)
+        return false;
+
+    xcb_list_properties_cookie_t cookie = { fListing };
+    xcb_generic_error_t* error = nullptr;
+    fListing = 0;
+    waited();
+    xcb_list_properties_reply_t* reply =
+        xcb_list_properties_reply(fConnection, cookie, &error);
+    free(error);
+    if (reply == nullptr)
+        return false;
+
+    int length = xcb_list_properties_atoms_length(reply);
+    const xcb_atom_t* source = xcb_list_properties_atoms(reply);
+    Atom* target = nullptr;
+    if (length > 0) {
+        target = (Atom *) malloc(length * sizeof(Atom));
+        for (int i = 0; i < length; ++i)
+            target[i] = source[i];
+    }
+    *count = length;
+    *atoms = target;
+    free(reply);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void YPrefetch::forget(Atom property) {
+#ifdef CONFIG_XCB
+    if (property == None) {
+        if (fWindowAttributes)
+            xcb_discard_reply(fConnection, fWindowAttributes);
+        if (fGeometry)
+            xcb_discard_reply(fConnection, fGeometry);
+        fWindowAttributes = fGeometry = 0;
+        fAttributed = false;
+        return;
+    }
+    int k = find(fAtoms, property);
+    if (0 <= k && fCookies[k]) {
+        xcb_discard_reply(fConnection, fCookies[k]);
+        fCookies[k] = 0;
+    }
+#endif
+}
+
+void YPrefetch::changed(Window window, Atom property) {
+    YPrefetch* active = prefetches.find(window);
+    if (active)
+        active->forget(property);
+}
+
+int YPrefetch::getAttributes(Window window, XWindowAttributes* attributes) {
+    YPrefetch* active = prefetches.find(window);
+    if (active && active->attributed(attributes)) {
+        active->fServed++;
+        return True;
+    }
+    ++fRoundTrips;
+    return XGetWindowAttributes(xapp->display(), window, attributes);
+}
+
+int YPrefetch::getProperty(Window window, Atom property, long limit,
+                           bool remove, Atom type, Atom* actual,
+                           int* format, unsigned long* count,
+                           unsigned long* after, unsigned char** data)
+{
+    YPrefetch* active = prefetches.find(window);
+    if (active && active->fetched(property, limit, remove, type,
+                                  actual, format, count, after, data))
+    {
+        active->fServed++;
+        return Success;
+    }
+    ++fRoundTrips;
+    return XGetWindowProperty(xapp->display(), window, property, 0L, limit,
+                              remove, type, actual, format, count, after,
+                              data);
+}
+
+Atom* YPrefetch::listProperties(Window window, int* count) {
+    Atom* atoms = nullptr;
+    YPrefetch* active = prefetches.find(window);
+    if (active && active->listed(count, &atoms)) {
+        active->fServed++;
+        return atoms;
+    }
+    ++fRoundTrips;
+    return XListProperties(xapp->display(), window, count);
+}
+
 // vim: set sw=4 ts=4 et:
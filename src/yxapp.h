@@ -90,6 +90,59 @@ private:
     bool fDelete;
 };
 
+// Request the attributes and many properties of one window in a batch.
+// While in scope, reads of that window are served from the batch
+// and cost one round trip in total. Batches for many windows
+// may be in flight at the same time.
+class YPrefetch {
+public:
+    YPrefetch(Window window, const Atom* atoms, int count);
+    ~YPrefetch();
+
+    Window window() const { return fWindow; }
+    int roundTrips() const { return fRoundTrips - fStartTrips; }
+    int prefetched() const { return fServed; }
+    static int totalTrips() { return fRoundTrips; }
+
+    // like XGetWindowAttributes
+    static int getAttributes(Window window, XWindowAttributes* attributes);
+    // like XGetWindowProperty
+    static int getProperty(Window window, Atom property, long limit,
+                           bool remove, Atom type, Atom* actual,
+                           int* format, unsigned long* count,
+                           unsigned long* after, unsigned char** data);
+    // like XListProperties
+    static Atom* listProperties(Window window, int* count);
+    // forget a prefetched property which is changed by us,
+    // or the attributes when the property is None
+    static void changed(Window window, Atom property);
+
+private:
+    bool attributed(XWindowAttributes* attributes);
+    bool fetched(Atom property, long limit, bool remove, Atom type,
+                 Atom* actual, int* format, unsigned long* count,
+                 unsigned long* after, unsigned char** data);
+    bool listed(int* count, Atom** atoms);
+    void forget(Atom property);
+    void waited();
+
+    Window fWindow;
+    YPrefetch* fPrevious;
+    int fStartTrips;
+    int fServed;
+    bool fWaited;
+    bool fAttributed;
+    XWindowAttributes fAttributes;
+    YArray<Atom> fAtoms;
+    YArray<unsigned> fCookies;
+    unsigned fListing;
+    unsigned fWindowAttributes;
+    unsigned fGeometry;
+    struct xcb_connection_t* fConnection;
+
+    static int fRoundTrips;
+};
+
 class YXPoll: public YPoll<class YXApplication> {
 public:
     explicit YXPoll(YXApplication* owner) : YPoll(owner) { }
@@ -115,6 +168,8 @@ public:
     Atom atom(const char* name) { return XInternAtom(display(), name, False); }
     void sync() const { XSync(display(), False); }
     void send(XClientMessageEvent& ev, Window win, long mask = NoEventMask) const;
+    // like XPutImage, but by shared memory for large images if possible
+    void putImage(Drawable drawable, GC gc, XImage* image, int x, int y);
     Window parent(Window child) const;
     bool children(Window win, Window** data, unsigned* num) const;
     bool queryMask(Window w, unsigned* mask);
@@ -243,9 +298,13 @@ private:
     bool fGrabTree;
     bool fGrabMouse;
     bool fReplayEvent;
+    int fXFlushes;
+    int fXDropped;
+    YArray<XEvent> fEventBatch;
 
     virtual bool handleXEvents();
     virtual void flushXEvents();
+    int compressEvents();
 
     void initModifiers();
     static XIM initInput(Display* dpy);
@@ -0,0 +1,108 @@
+/*
+ *  IceWM - Mapping of windows to pointers
+ *
+ *  Release under terms of the GNU Library General Public License
+ */
+
+#include "config.h"
+#include "yxcontext.h"
+#include "base.h"
+#include <string.h>
+
+YAnyContext::~YAnyContext() {
+    delete[] fTable;
+    if (verbose) {
+        tlog("%s: destroyed", title);
+    }
+}
+
+void YAnyContext::resize(unsigned size) {
+    Entry* old = fTable;
+    unsigned oldSize = old ? fMask + 1 : 0;
+
+    fTable = new Entry[size];
+    memset(fTable, 0, size * sizeof(Entry));
+    fMask = size - 1;
+    fShift = 64;
+    for (unsigned n = size; n > 1; n >>= 1)
+        --fShift;
+
+    for (unsigned k = 0; k < oldSize; ++k) {
+        if (old[k].key != None) {
+            unsigned i = home(old[k].key);
+            while (fTable[i].key != None)
+                i = (i + 1) & fMask;
+            fTable[i] = old[k];
+        }
+    }
+    delete[] old;
+
+    if (verbose) {
+        tlog("%s: resized to %u for %u", title, size, fCount);
+    }
+}
+
+void YAnyContext::save(Window w, AnyPointer p) {
+    if (w == None)
+        return;
+
+    Entry* e = lookup(w);
+    if (e == nullptr) {
+        // keep the load factor below two thirds
+        if (fTable == nullptr)
+            resize(32);
+        else if (3 * (fCount + 1) > 2 * (fMask + 1))
+            resize(2 * (fMask + 1));
+
+        unsigned i = home(w);
+        while (fTable[i].key != None)
+            i = (i + 1) & fMask;
+        e = &fTable[i];
+        e->key = w;
+        ++fCount;
+    }
+    e->value = p;
+
+    if (verbose) {
+        tlog("%s: save 0x%lx to %p", title, w, p);
+    }
+}
+
+bool YAnyContext::remove(Window w) {
+    Entry* e = lookup(w);
+    if (e == nullptr) {
+        if (verbose)
+            tlog("%s: remove for 0x%lx failed", title, w);
+        return false;
+    }
+
+    // shift following entries of the same probe sequence backwards
+    unsigned hole = unsigned(e - fTable);
+    for (unsigned i = (hole + 1) & fMask;
+         fTable[i].key != None;
+         i = (i + 1) & fMask)
+    {
+        unsigned want = home(fTable[i].key);
+        if (((i - want) & fMask) >= ((i - hole) & fMask)) {
+            fTable[hole] = fTable[i];
+            hole = i;
+        }
+    }
+    fTable[hole].key = None;
+    fTable[hole].value = nullptr;
+    --fCount;
+
+    if (verbose) {
+        tlog("%s: remove for 0x%lx", title, w);
+    }
+    return true;
+}
+
+void YAnyContext::logFind(Window w, Entry* e) const {
+    if (e)
+        tlog("%s: find 0x%lx found %p", title, w, e->value);
+    else
+        tlog("%s: find 0x%lx not found", title, w);
+}
+
+// vim: set sw=4 ts=4 et:
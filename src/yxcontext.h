@@ -1,80 +1,80 @@
 #ifndef __YXCONTEXT_H
 #define __YXCONTEXT_H
 
-#ifndef NULLQUARK
-#include <X11/Xresource.h>
-#endif
+#include <X11/X.h>
 
+// An open addressing hash table which maps windows to pointers.
+// It replaces the XContext database of Xlib, which locks the display
+// and chains entries in buckets for every lookup.
+// Linear probing with backward shift deletion avoids tombstones.
+// The None window marks an empty slot and cannot be stored.
 class YAnyContext {
 protected:
     typedef void* AnyPointer;
 
 private:
-    XContext unique;
+    struct Entry {
+        Window key;
+        AnyPointer value;
+    };
+
+    Entry* fTable;
+    unsigned fMask;
+    unsigned fShift;
+    unsigned fCount;
     const char* title;
     const bool verbose;
 
-    XContext context() {
-        if (unique == 0) {
-            unique = XUniqueContext();
-            if (verbose) {
-                tlog("%s: created", title);
+    unsigned home(Window w) const {
+        // Fibonacci hashing spreads consecutive resource identifiers
+        return unsigned((w * 0x9E3779B97F4A7C15ULL) >> fShift) & fMask;
+    }
+
+    Entry* lookup(Window w) const {
+        if (fTable && w != None) {
+            for (unsigned i = home(w); fTable[i].key != None; i = (i + 1) & fMask) {
+                if (fTable[i].key == w)
+                    return &fTable[i];
             }
         }
-        return unique;
+        return nullptr;
     }
 
-    Display* dpy() const { return xapp->display(); }
+    void resize(unsigned size);
+    void logFind(Window w, Entry* e) const;
+
+    YAnyContext(const YAnyContext&) = delete;
+    YAnyContext& operator=(const YAnyContext&) = delete;
 
 public:
     YAnyContext(const char* title = nullptr, bool verbose = false) :
-        unique(0),
+        fTable(nullptr),
+        fMask(0),
+        fShift(0),
+        fCount(0),
         title(title),
         verbose(verbose)
     {
     }
 
-    ~YAnyContext() {
-        if (verbose) {
-            tlog("%s: destroyed", title);
-        }
-    }
+    ~YAnyContext();
 
     // store mapping of window to pointer
-    void save(Window w, AnyPointer p) {
-        const char* q = static_cast<const char *>(p);
-        XSaveContext(dpy(), w, context(), q);
-        if (verbose) {
-            tlog("%s: save 0x%lx to %p", title, w, p);
-        }
-    }
+    void save(Window w, AnyPointer p);
 
     // lookup pointer by window
-    bool find(Window w, AnyPointer* p) {
-        char* q = nullptr;
-        int rc = XFindContext(dpy(), w, context(), &q);
-        if (verbose) {
-            if (rc == 0)
-                tlog("%s: find 0x%lx found %p", title, w,
-                        reinterpret_cast<void *>(p));
-            else
-                tlog("%s: find 0x%lx not found", title, w);
-        }
-        *p = q;
-        return rc == 0;
+    bool find(Window w, AnyPointer* p) const {
+        Entry* e = lookup(w);
+        if (verbose)
+            logFind(w, e);
+        *p = e ? e->value : nullptr;
+        return e != nullptr;
     }
 
     // remove mapping of window to pointer
-    bool remove(Window w) {
-        int rc = XDeleteContext(dpy(), w, context());
-        if (verbose) {
-            if (rc == 0)
-                tlog("%s: remove for 0x%lx", title, w);
-            else
-                tlog("%s: remove for 0x%lx failed", title, w);
-        }
-        return rc == 0;
-    }
+    bool remove(Window w);
+
+    unsigned count() const { return fCount; }
 };
 
 template <typename T>
@@ -90,7 +90,7 @@ public:
     }
 
     // lookup pointer by window
-    bool find(Window w, TPtr* ptr) {
+    bool find(Window w, TPtr* ptr) const {
         AnyPointer p = nullptr;
         if (YAnyContext::find(w, &p)) {
             *ptr = TPtr(p);
@@ -100,7 +100,7 @@ public:
     }
 
     // lookup pointer by window
-    TPtr find(Window w) {
+    TPtr find(Window w) const {
         AnyPointer p = nullptr;
         YAnyContext::find(w, &p);
         return TPtr(p);
@@ -110,6 +110,10 @@ public:
     bool remove(Window w) {
         return YAnyContext::remove(w);
     }
+
+    unsigned count() const {
+        return YAnyContext::count();
+    }
 };
 
 class YFrameClient;
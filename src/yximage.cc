@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include <errno.h>
+#include <stdint.h>
 
 // include png before X11 or libpng checks will fail on setjmp version
 #ifdef CONFIG_LIBPNG
@@ -14,6 +15,8 @@
 #include "yimage.h"
 #include "yxapp.h"
 #include "ypointer.h"
+#include "yscale.h"
+#include "ypixels.h"
 #include "intl.h"
 
 #include <X11/xpm.h>
@@ -81,6 +84,8 @@ public:
     bool hasAlpha() const { return fImage ? fImage->depth == 32 : false; }
     ref<YImage> upscale(unsigned width, unsigned height);
     ref<YImage> downscale(unsigned width, unsigned height);
+    XImage* boxScaled(unsigned width, unsigned height, unsigned depth,
+                      bool upscaling);
     virtual ref<YImage> subimage(int x, int y, unsigned width, unsigned height);
     virtual void save(upath filename);
 
@@ -664,263 +669,113 @@ ref<YImage> YXImage::loadjpg(upath filename)
 }
 #endif
 
-ref<YImage> YXImage::upscale(unsigned nw, unsigned nh)
+// let the most opaque pixel become fully opaque
+static void stretchAlpha(uint32_t* pixels, unsigned w, unsigned h,
+                         unsigned stride)
 {
-    ref<YImage> image;
-    XImage *ximage = 0;
-    double *chanls = 0;
-    double *counts = 0;
-    double *colors = 0;
+    uint32_t amax = 0;
+    for (unsigned j = 0; j < h; j++)
+        for (unsigned i = 0; i < w; i++)
+            amax = max(amax, pixels[j * stride + i] >> 24);
+    if (amax == 255)
+        return;
 
-    if (!valid()) {
-        tlog("ERROR: not a valid YXImage\n");
-        goto error;
+    uint32_t alpha[256];
+    for (unsigned a = 0; a < 256; a++) {
+        if (!amax)
+            /* no opacity at all! */
+            alpha[a] = 0xFF000000;
+        else
+            alpha[a] = min(255U, (a * 255 + amax / 2) / amax) << 24;
     }
-    {
-        unsigned w = fImage->width;
-        unsigned h = fImage->height;
-        bool has_alpha = hasAlpha();
-
-        // tlog("upscale from %ux%ux%u to %ux%u\n", w, h, d, nw, nh);
-        ximage = createImage(nw, nh, fImage->depth);
-        if (ximage == 0) {
-            goto error;
-        }
-        // tlog("created upscale ximage at %ux%ux%u\n", ximage->width, ximage->height, ximage->depth);
-        if (!(chanls = (double *)calloc(ximage->bytes_per_line * ximage->height, 4 * sizeof(*chanls)))) {
-            tlog("ERROR: could not allocate working arrays\n");
-            goto error;
-        }
-        if (!(counts = (double *)calloc(ximage->bytes_per_line * ximage->height, sizeof(*counts)))) {
-            tlog("ERROR: could not allocate working arrays\n");
-            goto error;
-        }
-        if (!(colors = (double *)calloc(ximage->bytes_per_line * ximage->height, sizeof(*colors)))) {
-            tlog("ERROR: could not allocate working arrays\n");
-            goto error;
-        }
-        {
-            double pppx = (double) w / (double) nw;
-            double pppy = (double) h / (double) nh;
-
-            double ty, by; unsigned l;
-            for (ty = 0.0, by = pppy, l = 0; l < nh; l++, ty += pppy, by += pppy) {
-                for (unsigned j = floor(ty); j < by; j++) {
-                    double yf = 1.0;
-                    if (ty < (j + 1) && (j + 1) < by)
-                        yf = (j + 1) - ty;
-                    else if (ty < j && j < by)
-                        yf = by - j;
-                    double lx, rx; unsigned k;
-                    for (lx = 0.0, rx = pppx, k = 0; k < nw; k++, lx += pppx, rx += pppx) {
-                        for (unsigned i = floor(lx); i < rx; i++) {
-                            double xf = 1.0;
-                            if (lx < (i + 1) && (i + 1) < rx)
-                                xf = (i + 1) - lx;
-                            else if (lx < i && i < rx)
-                                xf = rx - i;
-                            double ff = xf * yf;
-                            unsigned m = l * nw + k;
-                            unsigned n = m << 2;
-                            counts[m] += ff;
-                            unsigned long pixel = XGetPixel(fImage, i, j);
-                            if (fBitmap && (pixel & 0x00FFFFFF))
-                                pixel |= 0x00FFFFFF;
-                            unsigned A = has_alpha ? (pixel >> 24) & 0xff : 255;
-                            unsigned R = (pixel >> 16) & 0xff;
-                            unsigned G = (pixel >>  8) & 0xff;
-                            unsigned B = (pixel >>  0) & 0xff;
-                            colors[m] += ff;
-                            chanls[n+0] += A * ff;
-                            chanls[n+1] += R * ff;
-                            chanls[n+2] += G * ff;
-                            chanls[n+3] += B * ff;
-                        }
-                    }
-                }
-            }
-            unsigned amax = 0;
-            for (unsigned l = 0; l < nh; l++) {
-                for (unsigned k = 0; k < nw; k++) {
-                    unsigned m = l * nw + k;
-                    unsigned n = m << 2;
-                    unsigned long pixel = 0;
-                    if (counts[m])
-                        pixel |= (lround(chanls[n+0] / counts[m]) & 0xff) << 24;
-                    if (colors[m]) {
-                        pixel |= (lround(chanls[n+1] / colors[m]) & 0xff) << 16;
-                        pixel |= (lround(chanls[n+2] / colors[m]) & 0xff) <<  8;
-                        pixel |= (lround(chanls[n+3] / colors[m]) & 0xff) <<  0;
-                    }
-                    XPutPixel(ximage, k, l, pixel);
-                    amax = max(amax, (unsigned)((pixel >> 24) & 0xff));
-                }
-            }
-            if (!amax)
-                /* no opacity at all! */
-                for (unsigned l = 0; l < nh; l++)
-                    for (unsigned k = 0; k < nw; k++)
-                        XPutPixel(ximage, k, l, XGetPixel(ximage, k, l) | 0xFF000000);
-            else if (amax < 255) {
-                double bump = (double) 255 / (double) amax;
-                for (unsigned l = 0; l < nh; l++)
-                    for (unsigned k = 0; k < nw; k++) {
-                        unsigned long pixel = XGetPixel(ximage, k, l);
-                        amax = (pixel >> 24) & 0xff;
-                        amax = lround((double) amax * bump);
-                        if (amax > 255)
-                            amax = 255;
-                        pixel = (pixel & 0x00FFFFFF) | (amax << 24);
-                        XPutPixel(ximage, k, l, pixel);
-                    }
-            }
-            image.init(new YXImage(ximage, fBitmap));
-            ximage = 0; // consumed above
-        }
+    for (unsigned j = 0; j < h; j++) {
+        uint32_t* row = pixels + j * stride;
+        for (unsigned i = 0; i < w; i++)
+            row[i] = (row[i] & 0x00FFFFFF) | alpha[row[i] >> 24];
     }
-  error:
-    if (chanls)
-        free(chanls);
-    if (counts)
-        free(counts);
-    if (colors)
-        free(colors);
-    if (ximage)
-        XDestroyImage(ximage);
-    return image;
 }
 
-// image downscaling using a fast bilinear interpolation algorithm
-ref<YImage> YXImage::downscale(unsigned newWidth, unsigned newHeight)
+// scale by an area weighted box filter over packed ARGB pixels,
+// when upscaling also whiten bitmaps and stretch the alpha channel
+XImage* YXImage::boxScaled(unsigned nw, unsigned nh, unsigned depth,
+                           bool upscaling)
 {
-    const unsigned oldWidth = this->width();
-    const unsigned oldHeight = this->height();
-    const unsigned shift = 10;
-
-    PRECONDITION(inrange(newWidth, 1U, oldWidth));
-    PRECONDITION(inrange(newHeight, 1U, oldHeight));
+    const unsigned w = fImage->width;
+    const unsigned h = fImage->height;
+    const bool has_alpha = hasAlpha();
 
-    XImage* ximage = createImage(newWidth, newHeight, 32U);
+    XImage* ximage = createImage(nw, nh, depth);
     if (ximage == 0)
-        return null;
-
-    unsigned long *red = new unsigned long[newWidth];
-    unsigned long *grn = new unsigned long[newWidth];
-    unsigned long *blu = new unsigned long[newWidth];
-    unsigned long *alp = new unsigned long[newWidth];
-    unsigned long *div = new unsigned long[newWidth];
-
-    unsigned hacc = 0;
-    unsigned h = 0;
-    unsigned mult = 0;
-    bool repeat = false;
-
-    for (unsigned y = 0; y < oldHeight; y = repeat ? y : 1 + y) {
-        if (hacc < newHeight) {
-            memset(red, 0, sizeof(*red) * newWidth);
-            memset(grn, 0, sizeof(*grn) * newWidth);
-            memset(blu, 0, sizeof(*blu) * newWidth);
-            memset(alp, 0, sizeof(*alp) * newWidth);
-            memset(div, 0, sizeof(*div) * newWidth);
-        }
-
-        if (repeat) {
-            repeat = false;
-            mult = (1 << shift) - mult;
-        }
-        else {
-            hacc += newHeight;
-            if (hacc <= oldHeight) {
-                mult = 1 << shift;
-            }
-            else {
-                mult = ((newHeight / 2) + (1 << shift)
-                     * (newHeight - (hacc - oldHeight)))
-                     / newHeight;
+        return 0;
+
+    asmart<uint32_t> packed;
+    const uint32_t* source;
+    unsigned stride;
+    const bool whiten = fBitmap && upscaling;
+    if (nativePixels(fImage) && has_alpha && !whiten) {
+        source = pixelRow(fImage, 0);
+        stride = fImage->bytes_per_line / 4;
+    }
+    else {
+        const bool native = nativePixels(fImage);
+        packed = new uint32_t[w * h];
+        for (unsigned j = 0; j < h; j++) {
+            const uint32_t* row = native ? pixelRow(fImage, j) : 0;
+            for (unsigned i = 0; i < w; i++) {
+                unsigned long pixel = row ? row[i] : XGetPixel(fImage, i, j);
+                if (whiten && (pixel & 0x00FFFFFF))
+                    pixel |= 0x00FFFFFF;
+                if (!has_alpha)
+                    pixel |= 0xFF000000;
+                packed[j * w + i] = uint32_t(pixel);
             }
         }
+        source = packed;
+        stride = w;
+    }
 
-        unsigned wacc = 0;
-        unsigned w = 0;
-        unsigned char* idata = (unsigned char *) fImage->data
-                               + y * fImage->bytes_per_line;
-        const bool has_alpha = hasAlpha();
-        for (unsigned x = 0; x < oldWidth; ++x) {
-            unsigned char r, g, b, a;
-            if (fImage->byte_order == MSBFirst) {
-                a = has_alpha ? *idata++ : 0xFF;
-                r = *idata++;
-                g = *idata++;
-                b = *idata++;
-            } else {
-                b = *idata++;
-                g = *idata++;
-                r = *idata++;
-                a = has_alpha ? *idata++ : 0xFF;
-            }
+    asmart<uint32_t> unpacked;
+    uint32_t* target;
+    unsigned pitch;
+    const bool direct = nativePixels(ximage);
+    if (direct) {
+        target = (uint32_t *) ximage->data;
+        pitch = ximage->bytes_per_line / 4;
+    }
+    else {
+        unpacked = new uint32_t[nw * nh];
+        target = unpacked;
+        pitch = nw;
+    }
 
-            wacc += newWidth;
-            if (wacc < oldWidth) {
-                red[w] += (mult << shift) * r;
-                grn[w] += (mult << shift) * g;
-                blu[w] += (mult << shift) * b;
-                alp[w] += (mult << shift) * a;
-                div[w] += mult << shift;
-            }
-            else {
-                unsigned m = (newWidth / 2 + (1 << shift)
-                           * (newWidth - (wacc - oldWidth)))
-                           / newWidth;
-                red[w] += m * mult * r;
-                grn[w] += m * mult * g;
-                blu[w] += m * mult * b;
-                alp[w] += m * mult * a;
-                div[w] += m * mult;
-                ++w;
-                wacc -= oldWidth;
-                if (wacc > 0) {
-                    m = (1 << shift) - m;
-                    red[w] += m * mult * r;
-                    grn[w] += m * mult * g;
-                    blu[w] += m * mult * b;
-                    alp[w] += m * mult * a;
-                    div[w] += m * mult;
-                }
-            }
-        }
+    boxScale(source, w, h, stride, target, nw, nh, pitch);
+    if (upscaling && has_alpha)
+        stretchAlpha(target, nw, nh, pitch);
 
-        if (hacc >= oldHeight) {
-            hacc -= oldHeight;
-            if (hacc > 0) {
-                repeat = true;
-            }
-            unsigned char* odata = (unsigned char *) ximage->data
-                                   + h * ximage->bytes_per_line;
-            for (unsigned k = 0; k < newWidth; ++k) {
-                unsigned long d = non_zero(div[k]);
-                if (ximage->byte_order == MSBFirst) {
-                    *odata++ = (unsigned char) (alp[k] / d);
-                    *odata++ = (unsigned char) (red[k] / d);
-                    *odata++ = (unsigned char) (grn[k] / d);
-                    *odata++ = (unsigned char) (blu[k] / d);
-                }
-                else {
-                    *odata++ = (unsigned char) (blu[k] / d);
-                    *odata++ = (unsigned char) (grn[k] / d);
-                    *odata++ = (unsigned char) (red[k] / d);
-                    *odata++ = (unsigned char) (alp[k] / d);
-                }
-            }
-            ++h;
-        }
-    }
+    if (!direct)
+        for (unsigned j = 0; j < nh; j++)
+            for (unsigned i = 0; i < nw; i++)
+                XPutPixel(ximage, i, j, target[j * pitch + i]);
 
-    delete[] red;
-    delete[] grn;
-    delete[] blu;
-    delete[] alp;
-    delete[] div;
+    return ximage;
+}
+
+ref<YImage> YXImage::upscale(unsigned nw, unsigned nh)
+{
+    XImage* ximage = boxScaled(nw, nh, fImage->depth, true);
+    if (ximage == 0)
+        return null;
+    return ref<YImage>(new YXImage(ximage, fBitmap));
+}
 
+ref<YImage> YXImage::downscale(unsigned nw, unsigned nh)
+{
+    PRECONDITION(inrange(nw, 1U, width()));
+    PRECONDITION(inrange(nh, 1U, height()));
+
+    XImage* ximage = boxScaled(nw, nh, 32U, false);
+    if (ximage == 0)
+        return null;
     return ref<YImage>(new YXImage(ximage));
 }
 
@@ -1105,7 +960,10 @@ ref <YPixmap> YXImage::renderToPixmap(unsigned depth, bool premult)
     {
         unsigned w = fImage->width;
         unsigned h = fImage->height;
-        if (hasAlpha())
+        const bool native = nativePixels(fImage);
+        if (hasAlpha() && native)
+            has_mask = translucentPixels(fImage);
+        else if (hasAlpha())
             for (unsigned j = 0; !has_mask && j < h; j++)
                 for (unsigned i = 0; !has_mask && i < w; i++)
                     if (((XGetPixel(fImage, i, j) >> 24) & 0xff) < 128)
@@ -1115,9 +973,11 @@ ref <YPixmap> YXImage::renderToPixmap(unsigned depth, bool premult)
             if (xdraw == 0) {
                 goto error;
             }
-            for (unsigned j = 0; j < h; j++)
-                for (unsigned i = 0; i < w; i++)
-                    XPutPixel(xdraw, i, j, XGetPixel(fImage, i, j));
+            if (native == false || copyPixels(fImage, xdraw) == false) {
+                for (unsigned j = 0; j < h; j++)
+                    for (unsigned i = 0; i < w; i++)
+                        XPutPixel(xdraw, i, j, XGetPixel(fImage, i, j));
+            }
         } else if (!(xdraw = XSubImage(fImage, 0, 0, w, h))) {
             tlog("ERROR: could not create subimage %ux%u\n", w, h);
             goto error;
@@ -1128,11 +988,15 @@ ref <YPixmap> YXImage::renderToPixmap(unsigned depth, bool premult)
         if (xmask == 0) {
             goto error;
         }
-        for (unsigned j = 0; j < h; j++)
-            for (unsigned i = 0; i < w; i++)
-                XPutPixel(xmask, i, j,
-                          !has_mask ||
-                          ((XGetPixel(fImage, i, j) >> 24) & 0xff) >= ATH);
+        if (native && xmask->byte_order == xmask->bitmap_bit_order) {
+            thresholdMask(fImage, xmask, has_mask, ATH);
+        } else {
+            for (unsigned j = 0; j < h; j++)
+                for (unsigned i = 0; i < w; i++)
+                    XPutPixel(xmask, i, j,
+                              !has_mask ||
+                              ((XGetPixel(fImage, i, j) >> 24) & 0xff) >= ATH);
+        }
         // tlog("created ximage %ux%ux%u for mask\n", xmask->width, xmask->height, xmask->depth);
 
         // tlog("next request %lu at %s: +%d : %s()\n", NextRequest(xapp->display()), __FILE__, __LINE__, __func__);
@@ -1150,7 +1014,7 @@ ref <YPixmap> YXImage::renderToPixmap(unsigned depth, bool premult)
         }
         // tlog("putting ximage %ux%ux%u to pixmap\n", xdraw->width, xdraw->height, xdraw->depth);
         // tlog("next request %lu at %s: +%d : %s()\n", NextRequest(xapp->display()), __FILE__, __LINE__, __func__);
-        XPutImage(xapp->display(), draw, gcd, xdraw, 0, 0, 0, 0, xdraw->width, xdraw->height);
+        xapp->putImage(draw, gcd, xdraw, 0, 0);
 
         // tlog("next request %lu at %s: +%d : %s()\n", NextRequest(xapp->display()), __FILE__, __LINE__, __func__);
         mask = XCreatePixmap(xapp->display(), xapp->root(), xmask->width, xmask->height, 1);